@@ -1,9 +1,9 @@
 #ifndef _DG_CONTAINER_H_
 #define _DG_CONTAINER_H_
 
-#include <set>
 #include <cassert>
-#include <algorithm>
+
+#include "ADT/SortedVectorSet.h"
 
 namespace dg {
 
@@ -12,14 +12,17 @@ namespace dg {
 //
 //   This is basically just a wrapper for real container, so that
 //   we have the container defined on one place for all edges.
-//   It may have more implementations depending on available features
+//   It may have more implementations depending on available features.
+//   Now it is a sorted array, so that the set operations
+//   are cache-friendly merges (vectorized for pointers) and the
+//   iteration order does not depend on the history of the container.
+//   Up to EXPECTED_ELEMENTS_NUM elements are stored inline.
 /// ------------------------------------------------------------------
 template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
 class DGContainer
 {
 public:
-    // XXX use llvm ADTs when available, or BDDs?
-    using ContainerT = typename std::set<ValueT>;
+    using ContainerT = ADT::SortedVectorSet<ValueT, EXPECTED_ELEMENTS_NUM>;
     using iterator = typename ContainerT::iterator;
     using const_iterator = typename ContainerT::const_iterator;
     using size_type = typename ContainerT::size_type;
@@ -39,6 +42,19 @@ public:
         return container.insert(n).second;
     }
 
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        container.insert(first, last);
+    }
+
+    // add all elements from the other container
+    // \return true if this container changed
+    bool insert(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth)
+    {
+        return container.merge(oth.container);
+    }
+
     bool contains(ValueT n) const
     {
         return container.count(n) != 0;
@@ -54,7 +70,7 @@ public:
         container.clear();
     }
 
-    bool empty()
+    bool empty() const
     {
         return container.empty();
     }
@@ -66,31 +82,17 @@ public:
 
     void intersect(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth)
     {
-        DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> tmp;
-
-        std::set_intersection(container.begin(), container.end(),
-                              oth.container.begin(),
-                              oth.container.end(),
-                              std::inserter(tmp.container,
-                                            tmp.container.begin()));
+        container.intersect(oth.container);
+    }
 
-        // swap containers
-        container.swap(tmp.container);
+    bool isSubsetOf(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
+    {
+        return container.isSubsetOf(oth.container);
     }
 
     bool operator==(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
     {
-        if (container.size() != oth.size())
-            return false;
-
-        // the sets are ordered, so this will work
-        iterator snd = oth.container.begin();
-        for (iterator fst = container.begin(), efst = container.end();
-             fst != efst; ++fst, ++snd)
-            if (*fst != *snd)
-                return false;
-
-        return true;
+        return container == oth.container;
     }
 
     bool operator!=(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
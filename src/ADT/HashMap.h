@@ -0,0 +1,277 @@
+#ifndef _DG_ADT_HASH_MAP_H_
+#define _DG_ADT_HASH_MAP_H_
+
+#include <deque>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <cassert>
+
+namespace dg {
+namespace ADT {
+
+/// ------------------------------------------------------------------
+// - HashMap
+//
+//   Map with an open-addressing hash index that iterates over
+//   the elements in the order in which they were inserted, so that
+//   the iteration does not depend on the values of the keys
+//   (e.g. on addresses of pointers). Erasing an element only marks
+//   it as erased, thus the iterators to other elements stay valid
+//   and it is safe to erase elements while iterating over the map.
+//   The erased elements are dropped when the index is rebuilt
+//   by insert() (also when there are more erased elements than
+//   the others) or by compact(). Only then the iterators and
+//   references to the elements get invalid, otherwise they stay
+//   valid, because the elements are stored in a deque.
+/// ------------------------------------------------------------------
+template <typename KeyT, typename ValueT, typename Hash = std::hash<KeyT>>
+class HashMap
+{
+public:
+    using key_type = KeyT;
+    using mapped_type = ValueT;
+    using value_type = std::pair<KeyT, ValueT>;
+    using size_type = size_t;
+
+private:
+    struct Entry {
+        value_type kv;
+        bool erased;
+
+        Entry(const KeyT& k, const ValueT& v) : kv(k, v), erased(false) {}
+    };
+
+    // the slots of the index keep the position of the entry + 1
+    enum : uint32_t { EMPTY = 0, ERASED = ~static_cast<uint32_t>(0) };
+
+    std::deque<Entry> entries;
+    std::vector<uint32_t> index;
+    // log2 of the size of the index
+    unsigned bits = 0;
+    // the number of elements that are not erased
+    size_t live = 0;
+    // the number of slots in the index that are not empty
+    size_t used = 0;
+
+    size_t slotOf(const KeyT& k) const
+    {
+        // fibonacci hashing, so that aligned pointers
+        // do not end up in the same slots
+        uint64_t h = static_cast<uint64_t>(Hash()(k));
+        return static_cast<size_t>((h * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+    }
+
+    // return the slot that contains @k or (size_t) -1
+    size_t lookup(const KeyT& k) const
+    {
+        if (index.empty())
+            return static_cast<size_t>(-1);
+
+        const size_t mask = index.size() - 1;
+        for (size_t s = slotOf(k);; s = (s + 1) & mask) {
+            uint32_t e = index[s];
+            if (e == EMPTY)
+                return static_cast<size_t>(-1);
+            if (e != ERASED && entries[e - 1].kv.first == k)
+                return s;
+        }
+    }
+
+    void rehash(size_t min_size)
+    {
+        unsigned nbits = 4;
+        while ((static_cast<size_t>(1) << nbits) < 2 * min_size)
+            ++nbits;
+
+        // drop the erased entries, keep the order of the others
+        if (entries.size() != live) {
+            std::deque<Entry> kept;
+            for (Entry& e : entries) {
+                if (!e.erased)
+                    kept.push_back(std::move(e));
+            }
+
+            entries.swap(kept);
+        }
+
+        bits = nbits;
+        index.assign(static_cast<size_t>(1) << bits, EMPTY);
+        used = 0;
+
+        const size_t mask = index.size() - 1;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            size_t s = slotOf(entries[i].kv.first);
+            while (index[s] != EMPTY)
+                s = (s + 1) & mask;
+
+            index[s] = i + 1;
+            ++used;
+        }
+    }
+
+    template <typename MapT, typename RefT>
+    class iterator_base
+    {
+        MapT *map;
+        size_t pos;
+
+        void skipErased()
+        {
+            while (pos < map->entries.size() && map->entries[pos].erased)
+                ++pos;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename HashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::remove_reference<RefT>::type *;
+        using reference = RefT;
+
+        iterator_base(MapT *map = nullptr, size_t pos = 0)
+        : map(map), pos(pos)
+        {
+            if (map)
+                skipErased();
+        }
+
+        // conversion from iterator to const_iterator
+        template <typename OMapT, typename ORefT>
+        iterator_base(const iterator_base<OMapT, ORefT>& it)
+        : map(it.map), pos(it.pos) {}
+
+        iterator_base& operator++()
+        {
+            ++pos;
+            skipErased();
+            return *this;
+        }
+
+        iterator_base operator++(int)
+        {
+            iterator_base tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        reference operator*() const { return map->entries[pos].kv; }
+        pointer operator->() const { return &map->entries[pos].kv; }
+
+        bool operator==(const iterator_base& oth) const { return pos == oth.pos; }
+        bool operator!=(const iterator_base& oth) const { return pos != oth.pos; }
+
+        friend class HashMap;
+        template <typename OMapT, typename ORefT>
+        friend class iterator_base;
+    };
+
+public:
+    using iterator = iterator_base<HashMap, value_type&>;
+    using const_iterator = iterator_base<const HashMap, const value_type&>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, entries.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, entries.size()); }
+
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+
+    iterator find(const KeyT& k)
+    {
+        size_t s = lookup(k);
+        return s == static_cast<size_t>(-1) ? end() : iterator(this, index[s] - 1);
+    }
+
+    const_iterator find(const KeyT& k) const
+    {
+        size_t s = lookup(k);
+        return s == static_cast<size_t>(-1) ? end() : const_iterator(this, index[s] - 1);
+    }
+
+    size_t count(const KeyT& k) const
+    {
+        return lookup(k) != static_cast<size_t>(-1);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v)
+    {
+        size_t s = lookup(v.first);
+        if (s != static_cast<size_t>(-1))
+            return {iterator(this, index[s] - 1), false};
+
+        // keep the index at most 3/4 full (including erased slots)
+        // and do not keep more erased entries than the others
+        if (4 * (used + 1) > 3 * index.size() || entries.size() - live > live)
+            rehash(live + 1);
+
+        assert(entries.size() + 1 < ERASED && "Too many elements");
+
+        const size_t mask = index.size() - 1;
+        s = slotOf(v.first);
+        while (index[s] != EMPTY && index[s] != ERASED)
+            s = (s + 1) & mask;
+
+        if (index[s] == EMPTY)
+            ++used;
+
+        entries.emplace_back(v.first, v.second);
+        index[s] = entries.size();
+        ++live;
+
+        return {iterator(this, entries.size() - 1), true};
+    }
+
+    std::pair<iterator, bool> emplace(const KeyT& k, const ValueT& v)
+    {
+        return insert(value_type(k, v));
+    }
+
+    ValueT& operator[](const KeyT& k)
+    {
+        return insert(value_type(k, ValueT())).first->second;
+    }
+
+    void erase(iterator it)
+    {
+        assert(it.map == this && it.pos < entries.size());
+        erase(it->first);
+    }
+
+    size_t erase(const KeyT& k)
+    {
+        size_t s = lookup(k);
+        if (s == static_cast<size_t>(-1))
+            return 0;
+
+        entries[index[s] - 1].erased = true;
+        index[s] = ERASED;
+        --live;
+        return 1;
+    }
+
+    // drop the erased elements, e.g. after erasing a lot of them.
+    // This invalidates the iterators and references
+    void compact()
+    {
+        if (entries.size() != live)
+            rehash(live);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        index.clear();
+        bits = 0;
+        live = used = 0;
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_HASH_MAP_H_
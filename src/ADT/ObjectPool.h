@@ -0,0 +1,172 @@
+#ifndef _DG_ADT_OBJECT_POOL_H_
+#define _DG_ADT_OBJECT_POOL_H_
+
+#include <cstdlib>
+#include <cstddef>
+#include <vector>
+#include <new>
+#include <cassert>
+
+namespace dg {
+namespace ADT {
+
+/// ------------------------------------------------------------------
+// - ObjectPool
+//
+//   Allocator of objects of (at most) one size. The memory is taken
+//   from the system in slabs of many objects and the freed objects
+//   are kept in a free list, so allocating and freeing an object
+//   is only a few instructions and the objects do not fragment the heap.
+//   All the slabs are released at once when the pool is destroyed,
+//   the objects in them must be destroyed before.
+//
+//   Every object is preceded by a header with the pool that allocated
+//   it, so the memory is returned to the right pool by the plain
+//   delete (see PoolAllocated). The pool is not thread-safe.
+/// ------------------------------------------------------------------
+class ObjectPool
+{
+    // the header keeps the alignment of the objects
+    static const size_t HEADER_SIZE = 16;
+
+    struct FreeChunk {
+        FreeChunk *next;
+    };
+
+    // the size of a chunk (the header + object)
+    size_t chunk_size;
+    // the number of chunks in the next slab
+    size_t slab_chunks = 32;
+
+    std::vector<void *> slabs;
+    FreeChunk *free_list = nullptr;
+    // unused part of the last slab
+    char *cur = nullptr;
+    char *cur_end = nullptr;
+    size_t live = 0;
+
+    static void *withHeader(void *chunk, ObjectPool *pool)
+    {
+        *static_cast<ObjectPool **>(chunk) = pool;
+        return static_cast<char *>(chunk) + HEADER_SIZE;
+    }
+
+    void *getChunk()
+    {
+        if (free_list) {
+            void *ret = free_list;
+            free_list = free_list->next;
+            return ret;
+        }
+
+        if (cur == cur_end) {
+            void *slab = std::malloc(slab_chunks * chunk_size);
+            if (!slab)
+                throw std::bad_alloc();
+
+            slabs.push_back(slab);
+            cur = static_cast<char *>(slab);
+            cur_end = cur + slab_chunks * chunk_size;
+            if (slab_chunks < 4096)
+                slab_chunks *= 2;
+        }
+
+        void *ret = cur;
+        cur += chunk_size;
+        return ret;
+    }
+
+public:
+    explicit ObjectPool(size_t object_size)
+    : chunk_size(HEADER_SIZE
+                 + (object_size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE) {}
+
+    ~ObjectPool()
+    {
+        for (void *slab : slabs)
+            std::free(slab);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // objects that do not fit into the chunks are allocated on the heap
+    void *allocate(size_t size)
+    {
+        if (size > chunk_size - HEADER_SIZE)
+            return allocateHeap(size);
+
+        ++live;
+        return withHeader(getChunk(), this);
+    }
+
+    static void *allocateHeap(size_t size)
+    {
+        void *chunk = std::malloc(HEADER_SIZE + size);
+        if (!chunk)
+            throw std::bad_alloc();
+
+        return withHeader(chunk, nullptr);
+    }
+
+    // return the memory of an object allocated by
+    // allocate() or allocateHeap()
+    static void release(void *ptr)
+    {
+        if (!ptr)
+            return;
+
+        void *chunk = static_cast<char *>(ptr) - HEADER_SIZE;
+        ObjectPool *pool = *static_cast<ObjectPool **>(chunk);
+        if (!pool) {
+            std::free(chunk);
+            return;
+        }
+
+        assert(pool->live > 0 && "Releasing more objects than allocated");
+        FreeChunk *fc = static_cast<FreeChunk *>(chunk);
+        fc->next = pool->free_list;
+        pool->free_list = fc;
+        --pool->live;
+    }
+
+    // the number of objects allocated from the slabs that were not released
+    size_t liveObjects() const { return live; }
+    size_t slabsNum() const { return slabs.size(); }
+};
+
+///
+// Base class of objects that can be allocated in an ObjectPool:
+//
+//   Obj *o = new (pool) Obj(...);
+//
+// The objects allocated by the plain new go to the heap.
+// Both are freed by the plain delete.
+struct PoolAllocated
+{
+    static void *operator new(size_t size)
+    {
+        return ObjectPool::allocateHeap(size);
+    }
+
+    static void *operator new(size_t size, ObjectPool& pool)
+    {
+        return pool.allocate(size);
+    }
+
+    static void operator delete(void *ptr)
+    {
+        ObjectPool::release(ptr);
+    }
+
+    // called when the constructor throws
+    static void operator delete(void *ptr, ObjectPool&)
+    {
+        ObjectPool::release(ptr);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_OBJECT_POOL_H_
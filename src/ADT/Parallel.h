@@ -0,0 +1,62 @@
+#ifndef _DG_ADT_PARALLEL_H_
+#define _DG_ADT_PARALLEL_H_
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace dg {
+namespace ADT {
+
+// get the number of threads to use when the user
+// asks for 0 threads (that is, "use what you have")
+inline unsigned getThreadsNum(unsigned requested)
+{
+    if (requested > 0)
+        return requested;
+
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+///
+// Call @f(i) for every i from [0, n) using at most @threads threads.
+// The indices are handed out dynamically one by one, so the work
+// of the calls does not need to be balanced. With one thread
+// (or one index) @f is called in order on the calling thread.
+template <typename F>
+void parallelFor(size_t n, unsigned threads, F f)
+{
+    if (threads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            f(i);
+        return;
+    }
+
+    if (threads > n)
+        threads = n;
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < n)
+            f(i);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+
+    // the calling thread works too
+    worker();
+
+    for (std::thread& thr : pool)
+        thr.join();
+}
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_PARALLEL_H_
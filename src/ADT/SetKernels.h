@@ -0,0 +1,232 @@
+#ifndef _DG_ADT_SET_KERNELS_H_
+#define _DG_ADT_SET_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define DG_SET_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace dg {
+namespace ADT {
+namespace kernels {
+
+/// ------------------------------------------------------------------
+// - Kernels for sorted arrays of 64-bit values
+//
+//   The kernels work on sorted arrays of pointers (or 64-bit unsigned
+//   numbers) without duplicates. The only vectorized primitive is
+//   'scan' that skips the prefix of an array that is smaller than
+//   a given key. Union, intersection and subset check are merges
+//   built on top of it, so runs of elements that are present only
+//   in one of the arrays are skipped (or copied) by blocks.
+//   The instruction set is selected once at runtime.
+/// ------------------------------------------------------------------
+enum class Level {
+    SCALAR,
+    SSE42,
+    AVX2
+};
+
+template <typename T>
+struct IsKernelType {
+    static const bool value = sizeof(T) == sizeof(uint64_t) &&
+                              (std::is_pointer<T>::value ||
+                               std::is_same<T, uint64_t>::value);
+};
+
+namespace detail {
+
+template <typename T>
+inline uint64_t key(T *v) { return reinterpret_cast<uintptr_t>(v); }
+inline uint64_t key(uint64_t v) { return v; }
+
+// return the index of the first element in arr[i, n)
+// that is not smaller than x
+template <typename T>
+size_t scanScalar(const T *arr, size_t i, size_t n, T x)
+{
+    std::less<T> lt;
+    while (i < n && lt(arr[i], x))
+        ++i;
+
+    return i;
+}
+
+#ifdef DG_SET_KERNELS_X86
+// there are only signed comparisons on 64-bit lanes,
+// so flip the sign bit of both operands
+template <typename T>
+__attribute__((target("sse4.2")))
+size_t scanSSE42(const T *arr, size_t i, size_t n, T x)
+{
+    if (i < n && !std::less<T>()(arr[i], x))
+        return i;
+
+    const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+    const __m128i k = _mm_xor_si128(_mm_set1_epi64x(key(x)), bias);
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arr + i));
+        __m128i lt = _mm_cmpgt_epi64(k, _mm_xor_si128(v, bias));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(lt));
+        // the array is sorted, so the mask is a prefix
+        if (mask != 0x3)
+            return i + __builtin_popcount(mask);
+    }
+
+    return scanScalar(arr, i, n, x);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+size_t scanAVX2(const T *arr, size_t i, size_t n, T x)
+{
+    if (i < n && !std::less<T>()(arr[i], x))
+        return i;
+
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x(key(x)), bias);
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arr + i));
+        __m256i lt = _mm256_cmpgt_epi64(k, _mm256_xor_si256(v, bias));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lt));
+        if (mask != 0xf)
+            return i + __builtin_popcount(mask);
+    }
+
+    return scanScalar(arr, i, n, x);
+}
+#endif // DG_SET_KERNELS_X86
+
+template <typename T>
+using ScanFn = size_t (*)(const T *, size_t, size_t, T);
+
+template <typename T>
+ScanFn<T> getScan(Level level)
+{
+#ifdef DG_SET_KERNELS_X86
+    switch (level) {
+        case Level::AVX2:
+            return scanAVX2<T>;
+        case Level::SSE42:
+            return scanSSE42<T>;
+        default:
+            break;
+    }
+#else
+    (void) level;
+#endif
+    return scanScalar<T>;
+}
+
+} // namespace detail
+
+inline Level detectLevel()
+{
+#ifdef DG_SET_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return Level::SSE42;
+#endif
+    return Level::SCALAR;
+}
+
+// the best level supported by this CPU, detected on the first use
+inline Level activeLevel()
+{
+    static const Level level = detectLevel();
+    return level;
+}
+
+// store a \cup b to out, out must have space for na + nb elements
+// \return the number of elements in out
+template <typename T>
+size_t setUnion(const T *a, size_t na, const T *b, size_t nb,
+                T *out, Level level = activeLevel())
+{
+    static_assert(IsKernelType<T>::value, "Unsupported type");
+    detail::ScanFn<T> scan = detail::getScan<T>(level);
+    std::less<T> lt;
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (lt(a[i], b[j])) {
+            size_t e = scan(a, i, na, b[j]);
+            out = std::copy(a + i, a + e, out);
+            k += e - i;
+            i = e;
+        } else if (lt(b[j], a[i])) {
+            size_t e = scan(b, j, nb, a[i]);
+            out = std::copy(b + j, b + e, out);
+            k += e - j;
+            j = e;
+        } else {
+            *out++ = a[i];
+            ++k, ++i, ++j;
+        }
+    }
+
+    std::copy(a + i, a + na, out);
+    std::copy(b + j, b + nb, out + (na - i));
+
+    return k + (na - i) + (nb - j);
+}
+
+// store a \cap b to out, out must have space for min(na, nb) elements
+// \return the number of elements in out
+template <typename T>
+size_t setIntersection(const T *a, size_t na, const T *b, size_t nb,
+                       T *out, Level level = activeLevel())
+{
+    static_assert(IsKernelType<T>::value, "Unsupported type");
+    detail::ScanFn<T> scan = detail::getScan<T>(level);
+    std::less<T> lt;
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (lt(a[i], b[j]))
+            i = scan(a, i, na, b[j]);
+        else if (lt(b[j], a[i]))
+            j = scan(b, j, nb, a[i]);
+        else {
+            out[k++] = a[i];
+            ++i, ++j;
+        }
+    }
+
+    return k;
+}
+
+// \return true iff a \subseteq b
+template <typename T>
+bool isSubset(const T *a, size_t na, const T *b, size_t nb,
+              Level level = activeLevel())
+{
+    static_assert(IsKernelType<T>::value, "Unsupported type");
+    if (na > nb)
+        return false;
+
+    detail::ScanFn<T> scan = detail::getScan<T>(level);
+    size_t j = 0;
+    for (size_t i = 0; i < na; ++i, ++j) {
+        j = scan(b, j, nb, a[i]);
+        if (j == nb || b[j] != a[i])
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace kernels
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_SET_KERNELS_H_
@@ -0,0 +1,255 @@
+#ifndef _DG_ADT_SMALL_VECTOR_H_
+#define _DG_ADT_SMALL_VECTOR_H_
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <new>
+#include <iterator>
+#include <type_traits>
+
+namespace dg {
+namespace ADT {
+
+/// ------------------------------------------------------------------
+// - SmallVector
+//
+//   Vector of trivially copyable elements that keeps up to N elements
+//   inline and allocates memory only when it grows bigger. The inline
+//   elements share the space with the pointer to the allocated memory,
+//   so for small N the vector is not bigger than std::vector.
+//   It has the subset of std::vector interface that we need,
+//   the iterators are plain pointers.
+/// ------------------------------------------------------------------
+template <typename T, unsigned N>
+class SmallVector
+{
+    static_assert(N > 0, "Use std::vector for no inline elements");
+#if !defined(__GNUC__) || __GNUC__ >= 5 || defined(__clang__)
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector moves the elements by memcpy");
+#endif
+
+    struct Heap {
+        T *ptr;
+        size_t capacity;
+    };
+
+    union {
+        Heap heap;
+        typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type small;
+    } storage;
+
+    uint32_t sz;
+    bool on_heap;
+
+    T *smallData() { return reinterpret_cast<T *>(&storage.small); }
+    const T *smallData() const { return reinterpret_cast<const T *>(&storage.small); }
+
+    void grow(size_t min_capacity)
+    {
+        size_t cap = 2 * capacity();
+        if (cap < min_capacity)
+            cap = min_capacity;
+
+        T *mem = static_cast<T *>(std::malloc(cap * sizeof(T)));
+        if (!mem)
+            throw std::bad_alloc();
+
+        std::memcpy(static_cast<void *>(mem), data(), sz * sizeof(T));
+        release();
+
+        storage.heap.ptr = mem;
+        storage.heap.capacity = cap;
+        on_heap = true;
+    }
+
+    void release()
+    {
+        if (on_heap)
+            std::free(storage.heap.ptr);
+        on_heap = false;
+    }
+
+    // make space for @n elements at @pos, return the new position
+    T *openGap(T *pos, size_t n)
+    {
+        size_t idx = pos - data();
+        assert(idx <= sz);
+        if (sz + n > capacity())
+            grow(sz + n);
+
+        T *p = data() + idx;
+        std::memmove(static_cast<void *>(p + n), p, (sz - idx) * sizeof(T));
+        sz += n;
+        return p;
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SmallVector() : sz(0), on_heap(false) {}
+
+    explicit SmallVector(size_t n) : sz(0), on_heap(false)
+    {
+        resize(n);
+    }
+
+    SmallVector(const SmallVector& oth) : sz(0), on_heap(false)
+    {
+        assign(oth.begin(), oth.end());
+    }
+
+    SmallVector(SmallVector&& oth) : sz(0), on_heap(false)
+    {
+        swap(oth);
+    }
+
+    ~SmallVector() { release(); }
+
+    SmallVector& operator=(const SmallVector& oth)
+    {
+        if (this != &oth)
+            assign(oth.begin(), oth.end());
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& oth)
+    {
+        if (this != &oth) {
+            clear();
+            swap(oth);
+        }
+        return *this;
+    }
+
+    T *data() { return on_heap ? storage.heap.ptr : smallData(); }
+    const T *data() const { return on_heap ? storage.heap.ptr : smallData(); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + sz; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + sz; }
+
+    size_t size() const { return sz; }
+    size_t capacity() const { return on_heap ? storage.heap.capacity : N; }
+    bool empty() const { return sz == 0; }
+
+    T& front() { assert(sz > 0); return data()[0]; }
+    const T& front() const { assert(sz > 0); return data()[0]; }
+    T& back() { assert(sz > 0); return data()[sz - 1]; }
+    const T& back() const { assert(sz > 0); return data()[sz - 1]; }
+
+    T& operator[](size_t i) { assert(i < sz); return data()[i]; }
+    const T& operator[](size_t i) const { assert(i < sz); return data()[i]; }
+
+    // the allocated memory is kept
+    void clear() { sz = 0; }
+
+    void reserve(size_t n)
+    {
+        if (n > capacity())
+            grow(n);
+    }
+
+    void resize(size_t n)
+    {
+        reserve(n);
+        for (size_t i = sz; i < n; ++i)
+            new (data() + i) T();
+        sz = n;
+    }
+
+    void push_back(const T& v)
+    {
+        if (sz == capacity()) {
+            // v can be an element of this vector
+            T tmp(v);
+            grow(sz + 1);
+            new (data() + sz) T(tmp);
+        } else {
+            new (data() + sz) T(v);
+        }
+        ++sz;
+    }
+
+    iterator insert(const_iterator pos, const T& v)
+    {
+        T tmp(v);
+        T *p = openGap(const_cast<T *>(pos), 1);
+        new (p) T(tmp);
+        return p;
+    }
+
+    template <typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        size_t n = std::distance(first, last);
+        T *p = openGap(const_cast<T *>(pos), n);
+        for (T *q = p; first != last; ++first, ++q)
+            new (q) T(*first);
+        return p;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        insert(end(), first, last);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        T *f = const_cast<T *>(first);
+        std::memmove(static_cast<void *>(f), last,
+                     (end() - last) * sizeof(T));
+        sz -= last - first;
+        return f;
+    }
+
+    // the elements are trivially copyable and there are no pointers
+    // into the object itself, so swapping the bytes is enough
+    void swap(SmallVector& oth)
+    {
+        if (this == &oth)
+            return;
+
+        unsigned char tmp[sizeof(SmallVector)];
+        std::memcpy(tmp, static_cast<void *>(this), sizeof(SmallVector));
+        std::memcpy(static_cast<void *>(this), static_cast<void *>(&oth),
+                    sizeof(SmallVector));
+        std::memcpy(static_cast<void *>(&oth), tmp, sizeof(SmallVector));
+    }
+
+    bool operator==(const SmallVector& oth) const
+    {
+        if (sz != oth.sz)
+            return false;
+
+        for (size_t i = 0; i < sz; ++i) {
+            if (!(data()[i] == oth.data()[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const SmallVector& oth) const
+    {
+        return !operator==(oth);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_SMALL_VECTOR_H_
@@ -0,0 +1,253 @@
+#ifndef _DG_ADT_SORTED_VECTOR_SET_H_
+#define _DG_ADT_SORTED_VECTOR_SET_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <utility>
+#include <type_traits>
+
+#include "ADT/SetKernels.h"
+#include "ADT/SmallVector.h"
+
+namespace dg {
+namespace ADT {
+
+/// ------------------------------------------------------------------
+// - SortedVectorSet
+//
+//   Set kept as a sorted array without duplicates. Lookups are binary
+//   searches and the bulk operations (merge, intersect, subset) are
+//   linear merges. When the elements are pointers, the merges are
+//   done by the vectorized kernels from SetKernels.h.
+//   If SMALL is not 0, up to SMALL elements are kept inline
+//   (see SmallVector) and they are searched linearly.
+//   Insertion and erasing invalidate the iterators.
+/// ------------------------------------------------------------------
+template <typename ValueT, unsigned int SMALL = 0>
+class SortedVectorSet
+{
+    using ContainerT = typename std::conditional<SMALL == 0,
+                                                 std::vector<ValueT>,
+                                                 SmallVector<ValueT, SMALL>>::type;
+    using UseKernels = std::integral_constant<bool,
+                                kernels::IsKernelType<ValueT>::value>;
+    ContainerT elems;
+
+    bool mergeImpl(const SortedVectorSet& oth, std::true_type)
+    {
+        ContainerT tmp(elems.size() + oth.elems.size());
+        size_t n = kernels::setUnion(elems.data(), elems.size(),
+                                     oth.elems.data(), oth.elems.size(),
+                                     tmp.data());
+        if (n == elems.size())
+            return false;
+
+        tmp.resize(n);
+        elems.swap(tmp);
+        return true;
+    }
+
+    bool mergeImpl(const SortedVectorSet& oth, std::false_type)
+    {
+        ContainerT tmp;
+        tmp.reserve(elems.size() + oth.elems.size());
+        std::set_union(elems.begin(), elems.end(),
+                       oth.elems.begin(), oth.elems.end(),
+                       std::back_inserter(tmp));
+        if (tmp.size() == elems.size())
+            return false;
+
+        elems.swap(tmp);
+        return true;
+    }
+
+    bool intersectImpl(const SortedVectorSet& oth, std::true_type)
+    {
+        // we can intersect in place, the output is never
+        // ahead of the input
+        size_t n = kernels::setIntersection(elems.data(), elems.size(),
+                                            oth.elems.data(), oth.elems.size(),
+                                            elems.data());
+        if (n == elems.size())
+            return false;
+
+        elems.resize(n);
+        return true;
+    }
+
+    bool intersectImpl(const SortedVectorSet& oth, std::false_type)
+    {
+        ContainerT tmp;
+        std::set_intersection(elems.begin(), elems.end(),
+                              oth.elems.begin(), oth.elems.end(),
+                              std::back_inserter(tmp));
+        if (tmp.size() == elems.size())
+            return false;
+
+        elems.swap(tmp);
+        return true;
+    }
+
+    bool isSubsetOfImpl(const SortedVectorSet& oth, std::true_type) const
+    {
+        return kernels::isSubset(elems.data(), elems.size(),
+                                 oth.elems.data(), oth.elems.size());
+    }
+
+    bool isSubsetOfImpl(const SortedVectorSet& oth, std::false_type) const
+    {
+        return std::includes(oth.elems.begin(), oth.elems.end(),
+                             elems.begin(), elems.end());
+    }
+
+public:
+    using value_type = ValueT;
+    using size_type = typename ContainerT::size_type;
+    // elements must not be modified in place, that could break the order.
+    // The iterators are plain pointers, so that a range of the set
+    // can be used in the same way as any other array of the elements
+    using iterator = const ValueT *;
+    using const_iterator = const ValueT *;
+
+    SortedVectorSet() = default;
+
+    template <typename InputIt>
+    SortedVectorSet(InputIt first, InputIt last)
+    {
+        insert(first, last);
+    }
+
+    const_iterator begin() const { return elems.data(); }
+    const_iterator end() const { return elems.data() + elems.size(); }
+
+    size_type size() const { return elems.size(); }
+    bool empty() const { return elems.empty(); }
+    void clear() { elems.clear(); }
+    void reserve(size_type n) { elems.reserve(n); }
+    void swap(SortedVectorSet& oth) { elems.swap(oth.elems); }
+    const ValueT *data() const { return elems.data(); }
+
+    const_iterator find(const ValueT& v) const
+    {
+        if (size() <= SMALL) {
+            for (auto it = begin(), et = end(); it != et; ++it) {
+                if (!(*it < v))
+                    return v < *it ? et : it;
+            }
+
+            return end();
+        }
+
+        auto it = std::lower_bound(begin(), end(), v);
+        if (it != end() && !(v < *it))
+            return it;
+
+        return end();
+    }
+
+    size_type count(const ValueT& v) const
+    {
+        return find(v) != end();
+    }
+
+    bool contains(const ValueT& v) const
+    {
+        return find(v) != end();
+    }
+
+    std::pair<iterator, bool> insert(const ValueT& v)
+    {
+        // appending is the most common case when
+        // the elements come in order
+        if (elems.empty() || elems.back() < v) {
+            elems.push_back(v);
+            return std::make_pair(end() - 1, true);
+        }
+
+        auto it = std::lower_bound(elems.begin(), elems.end(), v);
+        if (!(v < *it))
+            return std::make_pair(&*it, false);
+
+        return std::make_pair(&*elems.insert(it, v), true);
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        SortedVectorSet tmp;
+        tmp.elems.assign(first, last);
+        std::sort(tmp.elems.begin(), tmp.elems.end());
+        tmp.elems.erase(std::unique(tmp.elems.begin(), tmp.elems.end()),
+                        tmp.elems.end());
+        merge(tmp);
+    }
+
+    size_type erase(const ValueT& v)
+    {
+        auto it = std::lower_bound(elems.begin(), elems.end(), v);
+        if (it == elems.end() || v < *it)
+            return 0;
+
+        elems.erase(it);
+        return 1;
+    }
+
+    iterator erase(const_iterator it)
+    {
+        auto pos = elems.erase(elems.begin() + (it - begin()));
+        return begin() + (pos - elems.begin());
+    }
+
+    // add all elements from oth to this set
+    // \return true if this set changed
+    bool merge(const SortedVectorSet& oth)
+    {
+        if (oth.empty() || this == &oth)
+            return false;
+
+        if (elems.empty()) {
+            elems = oth.elems;
+            return true;
+        }
+
+        // all new elements go to the end
+        if (elems.back() < oth.elems.front()) {
+            elems.insert(elems.end(), oth.elems.begin(), oth.elems.end());
+            return true;
+        }
+
+        return mergeImpl(oth, UseKernels());
+    }
+
+    // keep only the elements that are also in oth
+    // \return true if this set changed
+    bool intersect(const SortedVectorSet& oth)
+    {
+        if (elems.empty() || this == &oth)
+            return false;
+
+        return intersectImpl(oth, UseKernels());
+    }
+
+    bool isSubsetOf(const SortedVectorSet& oth) const
+    {
+        return isSubsetOfImpl(oth, UseKernels());
+    }
+
+    bool operator==(const SortedVectorSet& oth) const
+    {
+        return elems == oth.elems;
+    }
+
+    bool operator!=(const SortedVectorSet& oth) const
+    {
+        return !operator==(oth);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_SORTED_VECTOR_SET_H_
@@ -5,9 +5,12 @@
 #define _BBLOCK_H_
 
 #include <cassert>
-#include <list>
+#include <vector>
+#include <algorithm>
+#include <set>
 
 #include "ADT/DGContainer.h"
+#include "ADT/ObjectPool.h"
 #include "analysis/Analysis.h"
 
 #ifndef ENABLE_CFG
@@ -18,10 +21,11 @@ namespace dg {
 
 /// ------------------------------------------------------------------
 // - BBlock
-//     Basic block structure for dependence graph
+//     Basic block structure for dependence graph. Blocks can be
+//     allocated in the pool of their graph.
 /// ------------------------------------------------------------------
 template <typename NodeT>
-class BBlock
+class BBlock : public ADT::PoolAllocated
 {
 public:
     using KeyT = typename NodeT::KeyType;
@@ -72,7 +76,7 @@ public:
     using BBlockContainerT = EdgesContainer<BBlock<NodeT>>;
     // we don't need labels with predecessors
     using PredContainerT = EdgesContainer<BBlock<NodeT>>;
-    using SuccContainerT = DGContainer<BBlockEdge>;
+    using SuccContainerT = DGContainer<BBlockEdge, 2>;
 
     SuccContainerT& successors() { return nextBBs; }
     const SuccContainerT& successors() const { return nextBBs; }
@@ -94,8 +98,8 @@ public:
     void setDG(DependenceGraphT *d) { dg = d; }
     DependenceGraphT *getDG() const { return dg; }
 
-    const std::list<NodeT *>& getNodes() const { return nodes; }
-    std::list<NodeT *>& getNodes() { return nodes; }
+    const std::vector<NodeT *>& getNodes() const { return nodes; }
+    std::vector<NodeT *>& getNodes() { return nodes; }
     bool empty() const { return nodes.empty(); }
     size_t size() const { return nodes.size(); }
 
@@ -112,7 +116,7 @@ public:
         assert(n && "Cannot add null node to BBlock");
 
         n->setBasicBlock(this);
-        nodes.push_front(n);
+        nodes.insert(nodes.begin(), n);
     }
 
     bool hasControlDependence() const
@@ -128,7 +132,7 @@ public:
         if (nextBBs.size() < 2)
             return true;
 
-        typename SuccContainerT::const_iterator start, iter, end;
+        typename SuccContainerT::const_iterator iter, end;
         iter = nextBBs.begin();
         end = nextBBs.end();
 
@@ -152,10 +156,10 @@ public:
             // find the edge that is going to this node
             // and create new edges to all successors. The new edges
             // will have the same label as the found one
-            DGContainer<BBlockEdge> new_edges;
-            for (auto I = pred->nextBBs.begin(),E = pred->nextBBs.end(); I != E;) {
-                auto cur = I++;
-                if (cur->target == this) {
+            SuccContainerT new_edges;
+            SuccContainerT old_edges;
+            for (const BBlockEdge& edge : pred->nextBBs) {
+                if (edge.target == this) {
                     // create edges that will go from the predecessor
                     // to every successor of this node
                     for (const BBlockEdge& succ : nextBBs) {
@@ -163,14 +167,18 @@ public:
                         // that would be incorrect. It can occur when we're isolatin a bblock
                         // with self-loop
                         if (succ.target != this)
-                            new_edges.insert(BBlockEdge(succ.target, cur->label));
+                            new_edges.insert(BBlockEdge(succ.target, edge.label));
                     }
 
-                    // remove the edge from predecessor
-                    pred->nextBBs.erase(*cur);
+                    old_edges.insert(edge);
                 }
             }
 
+            // remove the edges from predecessor. Do it after the loop,
+            // erasing from the container invalidates its iterators
+            for (const BBlockEdge& edge : old_edges)
+                pred->nextBBs.erase(edge);
+
             // add newly created edges to predecessor
             for (const BBlockEdge& edge : new_edges) {
                 assert(edge.target != this
@@ -244,7 +252,10 @@ public:
         delete this;
     }
 
-    void removeNode(NodeT *n) { nodes.remove(n); }
+    void removeNode(NodeT *n)
+    {
+        nodes.erase(std::remove(nodes.begin(), nodes.end(), n), nodes.end());
+    }
 
     size_t successorsNum() const { return nextBBs.size(); }
     size_t predecessorsNum() const { return prevBBs.size(); }
@@ -453,8 +464,9 @@ private:
     // reference to dg if needed
     DependenceGraphT *dg;
 
-    // nodes contained in this bblock
-    std::list<NodeT *> nodes;
+    // nodes contained in this bblock. A vector, because the blocks
+    // are traversed much more often than they are changed
+    std::vector<NodeT *> nodes;
 
     SuccContainerT nextBBs;
     PredContainerT prevBBs;
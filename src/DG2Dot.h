@@ -51,7 +51,7 @@ public:
     DG2Dot<NodeT>(DependenceGraph<NodeT> *dg,
                   uint32_t opts = PRINT_CFG | PRINT_DD | PRINT_CD,
                   const char *file = NULL)
-        : options(opts), dg(dg), file(file)
+        : options(opts), file(file), dg(dg)
     {
         // if a graph has no global nodes, this will forbid trying to print them
         dumpedGlobals.insert(nullptr);
@@ -582,11 +582,11 @@ private:
     const char *dd_color = "black";
     const char *cd_color = "blue";
 
-    DependenceGraph<NodeT> *dg;
     const char *file;
     std::set<DependenceGraph<NodeT> *> subgraphs;
 
 protected:
+    DependenceGraph<NodeT> *dg;
     std::ofstream out;
 };
 
@@ -4,10 +4,10 @@
 #ifndef _DG_PARAMETERS_H_
 #define _DG_PARAMETERS_H_
 
-#include <map>
 #include <utility>
 
 #include "BBlock.h"
+#include "ADT/HashMap.h"
 
 namespace dg {
 
@@ -55,7 +55,7 @@ class DGParameters
 {
 public:
     using KeyT = typename NodeT::KeyType;
-    using ContainerType = std::map<KeyT, DGParameter<NodeT>>;
+    using ContainerType = ADT::HashMap<KeyT, DGParameter<NodeT>>;
     using iterator = typename ContainerType::iterator;
     using const_iterator = typename ContainerType::const_iterator;
 
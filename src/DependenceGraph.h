@@ -6,10 +6,14 @@
 #include <map>
 #include <cassert>
 #include <memory>
+#include <vector>
 
 #include "BBlock.h"
 #include "ADT/DGContainer.h"
+#include "ADT/HashMap.h"
+#include "ADT/ObjectPool.h"
 #include "Node.h"
+#include "FrozenEdges.h"
 
 #include "analysis/Analysis.h"
 
@@ -37,7 +41,8 @@ public:
     // type of this dependence graph - so that we can refer to it in the code
     using DependenceGraphT = typename NodeT::DependenceGraphType;
 
-    using ContainerType = std::map<KeyT, NodeT *>;
+    // the nodes are iterated in the order in which they were added
+    using ContainerType = ADT::HashMap<KeyT, NodeT *>;
     using iterator = typename ContainerType::iterator;
     using const_iterator = typename ContainerType::const_iterator;
 #ifdef ENABLE_CFG
@@ -45,6 +50,14 @@ public:
 #endif
 
 private:
+    // memory for the nodes and blocks of this graph. The pools are
+    // declared first, so that they are released only after all
+    // the nodes and blocks were deleted
+    ADT::ObjectPool nodesPool;
+#ifdef ENABLE_CFG
+    ADT::ObjectPool blocksPool;
+#endif
+
     // entry and exit nodes of the graph
     NodeT *entryNode;
     NodeT *exitNode;
@@ -87,10 +100,17 @@ protected:
     // container that can be shared accross the graphs
     // (therefore it is a pointer)
     std::shared_ptr<ContainerType> global_nodes;
+    // packed edges of the nodes if the graph is frozen,
+    // it may be shared with other graphs
+    std::shared_ptr<FrozenEdges<NodeT>> frozen_edges;
 
 public:
     DependenceGraph<NodeT>()
-        : entryNode(nullptr), exitNode(nullptr), formalParameters(nullptr),
+        : nodesPool(sizeof(NodeT)),
+#ifdef ENABLE_CFG
+          blocksPool(sizeof(BBlock<NodeT>)),
+#endif
+          entryNode(nullptr), exitNode(nullptr), formalParameters(nullptr),
           refcount(1), slice_id(0)
 #ifdef ENABLE_CFG
         , entryBB(nullptr), exitBB(nullptr), PDTreeRoot(nullptr)
@@ -129,7 +149,11 @@ public:
 
     // operator [] for local nodes
     NodeT *operator[](KeyT k) { return nodes[k]; }
-    const NodeT *operator[](KeyT k) const { return nodes[k]; }
+    const NodeT *operator[](KeyT k) const
+    {
+        auto it = nodes.find(k);
+        return it == nodes.end() ? nullptr : it->second;
+    }
 
     // reference getter for fast include-if-null operation
     NodeT *& getRef(KeyT k) { return nodes[k]; }
@@ -248,6 +272,15 @@ public:
         global_nodes = ngn;
     }
 
+    // The nodes and blocks allocated as new (getNodesPool()) NodeT(...)
+    // are freed by delete as usual, but all the memory is returned
+    // to the system at once with the graph. Only the nodes that die
+    // before the graph can be allocated here (not the global nodes).
+    ADT::ObjectPool& getNodesPool() { return nodesPool; }
+#ifdef ENABLE_CFG
+    ADT::ObjectPool& getBlocksPool() { return blocksPool; }
+#endif
+
     // allocate new global nodes
     void allocateGlobalNodes()
     {
@@ -390,6 +423,40 @@ public:
         return n != nullptr;
     }
 
+    // Pack the edges of the nodes of this graph (and of the nodes
+    // connected to them) into one array, see FrozenEdges. It is meant
+    // for graphs that will not change, but the nodes can be still
+    // modified, they just get back their own containers then.
+    // Freezing a frozen graph does nothing.
+    void freeze()
+    {
+        if (frozen_edges)
+            return;
+
+        std::vector<NodeT *> seeds;
+        seeds.reserve(nodes.size());
+        for (auto& it : nodes)
+            seeds.push_back(it.second);
+
+        auto F = std::make_shared<FrozenEdges<NodeT>>();
+        F->build(seeds.begin(), seeds.end());
+        setFrozenEdges(F);
+    }
+
+    bool isFrozen() const { return frozen_edges != nullptr; }
+
+    // the graph keeps the packed edges alive, so all graphs
+    // whose nodes use @F must have it set
+    void setFrozenEdges(const std::shared_ptr<FrozenEdges<NodeT>>& F)
+    {
+        frozen_edges = F;
+    }
+
+    const std::shared_ptr<FrozenEdges<NodeT>>& getFrozenEdges() const
+    {
+        return frozen_edges;
+    }
+
     DGContainer<NodeT *>& getCallers() { return callers; }
     const DGContainer<NodeT *>& getCallers() const { return callers; }
     bool addCaller(NodeT *sg) { return callers.insert(sg); }
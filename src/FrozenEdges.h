@@ -0,0 +1,128 @@
+#ifndef _DG_FROZEN_EDGES_H_
+#define _DG_FROZEN_EDGES_H_
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cassert>
+
+namespace dg {
+
+/// ------------------------------------------------------------------
+// - FrozenEdges
+//
+//   Dependence edges of nodes packed into one array (compressed sparse
+//   rows). The edges of one node are next to each other: control
+//   dependencies, reverse control dependencies, data dependencies and
+//   reverse data dependencies. When the edges are packed, the nodes
+//   give up their own containers and their edge iterators point
+//   into this array. A node that is modified later gets its own
+//   containers back, so this object must live as long as the nodes.
+/// ------------------------------------------------------------------
+template <typename NodeT>
+class FrozenEdges
+{
+public:
+    enum Kind {
+        CD = 0,
+        REV_CD,
+        DD,
+        REV_DD,
+        KINDS_NUM
+    };
+
+    using const_iterator = NodeT * const *;
+
+    const_iterator begin(uint32_t id, Kind k) const
+    {
+        return edges.data() + offsets[KINDS_NUM * id + k];
+    }
+
+    const_iterator end(uint32_t id, Kind k) const
+    {
+        return edges.data() + offsets[KINDS_NUM * id + k + 1];
+    }
+
+    size_t size(uint32_t id, Kind k) const
+    {
+        return offsets[KINDS_NUM * id + k + 1] - offsets[KINDS_NUM * id + k];
+    }
+
+    // the number of nodes and edges (every edge is counted twice)
+    size_t nodesNum() const { return offsets.empty() ? 0 : (offsets.size() - 1) / KINDS_NUM; }
+    size_t edgesNum() const { return edges.size(); }
+
+    // pack the edges of the nodes from [first, last) and of all
+    // the nodes that are connected to them by some edge
+    template <typename InputIt>
+    void build(InputIt first, InputIt last)
+    {
+        assert(edges.empty() && "Already built");
+
+        std::vector<NodeT *> nodes;
+        std::unordered_map<NodeT *, uint32_t> ids;
+        auto add = [&nodes, &ids](NodeT *n) {
+            if (ids.emplace(n, nodes.size()).second)
+                nodes.push_back(n);
+        };
+
+        for (InputIt it = first; it != last; ++it)
+            add(*it);
+
+        // the nodes array grows while we go over it
+        size_t edges_num = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            NodeT *n = nodes[i];
+            for (NodeT *oth : Range(n->control_begin(), n->control_end()))
+                add(oth);
+            for (NodeT *oth : Range(n->rev_control_begin(), n->rev_control_end()))
+                add(oth);
+            for (NodeT *oth : Range(n->data_begin(), n->data_end()))
+                add(oth);
+            for (NodeT *oth : Range(n->rev_data_begin(), n->rev_data_end()))
+                add(oth);
+
+            edges_num += n->getControlDependenciesNum()
+                         + n->getRevControlDependenciesNum()
+                         + n->getDataDependenciesNum()
+                         + n->getRevDataDependenciesNum();
+        }
+
+        assert(edges_num <= UINT32_MAX && "Too many edges");
+        edges.reserve(edges_num);
+        offsets.reserve(KINDS_NUM * nodes.size() + 1);
+
+        for (NodeT *n : nodes) {
+            offsets.push_back(edges.size());
+            edges.insert(edges.end(), n->control_begin(), n->control_end());
+            offsets.push_back(edges.size());
+            edges.insert(edges.end(), n->rev_control_begin(), n->rev_control_end());
+            offsets.push_back(edges.size());
+            edges.insert(edges.end(), n->data_begin(), n->data_end());
+            offsets.push_back(edges.size());
+            edges.insert(edges.end(), n->rev_data_begin(), n->rev_data_end());
+        }
+        offsets.push_back(edges.size());
+
+        // now let the nodes use the packed edges
+        for (size_t i = 0; i < nodes.size(); ++i)
+            nodes[i]->setFrozenEdges(this, i);
+    }
+
+private:
+    struct Range {
+        const_iterator b, e;
+        Range(const_iterator b, const_iterator e) : b(b), e(e) {}
+        const_iterator begin() const { return b; }
+        const_iterator end() const { return e; }
+    };
+
+    std::vector<NodeT *> edges;
+    // the edges of the node with id I and kind K
+    // are [offsets[4*I + K], offsets[4*I + K + 1])
+    std::vector<uint32_t> offsets;
+};
+
+} // namespace dg
+
+#endif // _DG_FROZEN_EDGES_H_
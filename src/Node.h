@@ -4,8 +4,12 @@
 #ifndef _NODE_H_
 #define _NODE_H_
 
+#include <set>
+
 #include "DGParameters.h"
 #include "ADT/DGContainer.h"
+#include "ADT/ObjectPool.h"
+#include "FrozenEdges.h"
 #include "analysis/Analysis.h"
 
 namespace dg {
@@ -19,10 +23,10 @@ class DependenceGraph;
 //     fully determined by the type of node. Dependence graph is just
 //     a container for nodes - everything interesting is here.
 //     Concrete implementation will inherit from an instance of this
-//     template.
+//     template. Nodes can be allocated in the pool of their graph.
 /// ------------------------------------------------------------------
 template <typename DependenceGraphT, typename KeyT, typename NodeT>
-class Node
+class Node : public ADT::PoolAllocated
 {
 public:
     using ControlEdgesT = EdgesContainer<NodeT>;
@@ -36,6 +40,7 @@ public:
     using const_control_iterator = typename ControlEdgesT::const_iterator;
     using data_iterator = typename DependenceEdgesT::iterator;
     using const_data_iterator = typename DependenceEdgesT::const_iterator;
+    using FrozenEdgesT = FrozenEdges<NodeT>;
 
     Node<DependenceGraphT, KeyT, NodeT>(const KeyT& k,
                                         DependenceGraphT *dg = nullptr)
@@ -72,6 +77,9 @@ public:
     // thus making 'n' control dependend on this node
     bool addControlDependence(NodeT * n)
     {
+        thaw();
+        n->thaw();
+
 #ifndef NDEBUG
         bool ret1;
 #endif
@@ -93,6 +101,9 @@ public:
     // thus making 'n' data dependend on this node
     bool addDataDependence(NodeT * n)
     {
+        thaw();
+        n->thaw();
+
 #ifndef NDEBUG
         bool ret1;
 #endif
@@ -117,6 +128,9 @@ public:
 #ifndef NDEBUG
         bool ret2;
 #endif
+        thaw();
+        n->thaw();
+
         ret1 = n->revDataDepEdges.erase(static_cast<NodeT *>(this));
 #ifndef NDEBUG
         ret2 =
@@ -136,6 +150,8 @@ public:
 #ifndef NDEBUG
         bool ret2;
 #endif
+        thaw();
+        n->thaw();
 
         ret1 = n->revControlDepEdges.erase(static_cast<NodeT *>(this));
 #ifndef NDEBUG
@@ -151,12 +167,14 @@ public:
 
     void removeOutcomingDDs()
     {
+        thaw();
         while (!dataDepEdges.empty())
             removeDataDependence(*dataDepEdges.begin());
     }
 
     void removeIncomingDDs()
     {
+        thaw();
         while (!revDataDepEdges.empty()) {
             NodeT *cd = *revDataDepEdges.begin();
             // this will remove the reverse control dependence from
@@ -175,12 +193,14 @@ public:
     // remove all control dependencies going from/to this node
     void removeOutcomingCDs()
     {
+        thaw();
         while (!controlDepEdges.empty())
             removeControlDependence(*controlDepEdges.begin());
     }
 
     void removeIncomingCDs()
     {
+        thaw();
         while (!revControlDepEdges.empty()) {
             NodeT *cd = *revControlDepEdges.begin();
             // this will remove the reverse control dependence from
@@ -230,33 +250,36 @@ public:
     }
 
     // control dependency edges iterators
-    control_iterator control_begin(void) { return controlDepEdges.begin(); }
-    const_control_iterator control_begin(void) const { return controlDepEdges.begin(); }
-    control_iterator control_end(void) { return controlDepEdges.end(); }
-    const_control_iterator control_end(void) const { return controlDepEdges.end(); }
+    control_iterator control_begin(void) { return edgesBegin(controlDepEdges, FrozenEdgesT::CD); }
+    const_control_iterator control_begin(void) const { return edgesBegin(controlDepEdges, FrozenEdgesT::CD); }
+    control_iterator control_end(void) { return edgesEnd(controlDepEdges, FrozenEdgesT::CD); }
+    const_control_iterator control_end(void) const { return edgesEnd(controlDepEdges, FrozenEdgesT::CD); }
 
     // reverse control dependency edges iterators
-    control_iterator rev_control_begin(void) { return revControlDepEdges.begin(); }
-    const_control_iterator rev_control_begin(void) const { return revControlDepEdges.begin(); }
-    control_iterator rev_control_end(void) { return revControlDepEdges.end(); }
-    const_control_iterator rev_control_end(void) const { return revControlDepEdges.end(); }
+    control_iterator rev_control_begin(void) { return edgesBegin(revControlDepEdges, FrozenEdgesT::REV_CD); }
+    const_control_iterator rev_control_begin(void) const { return edgesBegin(revControlDepEdges, FrozenEdgesT::REV_CD); }
+    control_iterator rev_control_end(void) { return edgesEnd(revControlDepEdges, FrozenEdgesT::REV_CD); }
+    const_control_iterator rev_control_end(void) const { return edgesEnd(revControlDepEdges, FrozenEdgesT::REV_CD); }
 
     // data dependency edges iterators
-    data_iterator data_begin(void) { return dataDepEdges.begin(); }
-    const_data_iterator data_begin(void) const { return dataDepEdges.begin(); }
-    data_iterator data_end(void) { return dataDepEdges.end(); }
-    const_data_iterator data_end(void) const { return dataDepEdges.end(); }
+    data_iterator data_begin(void) { return edgesBegin(dataDepEdges, FrozenEdgesT::DD); }
+    const_data_iterator data_begin(void) const { return edgesBegin(dataDepEdges, FrozenEdgesT::DD); }
+    data_iterator data_end(void) { return edgesEnd(dataDepEdges, FrozenEdgesT::DD); }
+    const_data_iterator data_end(void) const { return edgesEnd(dataDepEdges, FrozenEdgesT::DD); }
 
     // reverse data dependency edges iterators
-    data_iterator rev_data_begin(void) { return revDataDepEdges.begin(); }
-    const_data_iterator rev_data_begin(void) const { return revDataDepEdges.begin(); }
-    data_iterator rev_data_end(void) { return revDataDepEdges.end(); }
-    const_data_iterator rev_data_end(void) const { return revDataDepEdges.end(); }
+    data_iterator rev_data_begin(void) { return edgesBegin(revDataDepEdges, FrozenEdgesT::REV_DD); }
+    const_data_iterator rev_data_begin(void) const { return edgesBegin(revDataDepEdges, FrozenEdgesT::REV_DD); }
+    data_iterator rev_data_end(void) { return edgesEnd(revDataDepEdges, FrozenEdgesT::REV_DD); }
+    const_data_iterator rev_data_end(void) const { return edgesEnd(revDataDepEdges, FrozenEdgesT::REV_DD); }
+
+    unsigned int getControlDependenciesNum() const { return edgesNum(controlDepEdges, FrozenEdgesT::CD); }
+    unsigned int getRevControlDependenciesNum() const { return edgesNum(revControlDepEdges, FrozenEdgesT::REV_CD); }
+    unsigned int getDataDependenciesNum() const { return edgesNum(dataDepEdges, FrozenEdgesT::DD); }
+    unsigned int getRevDataDependenciesNum() const { return edgesNum(revDataDepEdges, FrozenEdgesT::REV_DD); }
 
-    unsigned int getControlDependenciesNum() const { return controlDepEdges.size(); }
-    unsigned int getRevControlDependenciesNum() const { return revControlDepEdges.size(); }
-    unsigned int getDataDependenciesNum() const { return dataDepEdges.size(); }
-    unsigned int getRevDataDependenciesNum() const { return revDataDepEdges.size(); }
+    // are the edges of this node packed in FrozenEdges?
+    bool isFrozen() const { return frozen != nullptr; }
 
 #ifdef ENABLE_CFG
     BBlock<NodeT> *getBBlock() { return basicBlock; }
@@ -341,6 +364,55 @@ protected:
     DependenceGraphT *dg;
 
 private:
+    const_data_iterator edgesBegin(const DependenceEdgesT& E,
+                                   typename FrozenEdgesT::Kind k) const
+    {
+        return frozen ? frozen->begin(frozen_id, k) : E.begin();
+    }
+
+    const_data_iterator edgesEnd(const DependenceEdgesT& E,
+                                 typename FrozenEdgesT::Kind k) const
+    {
+        return frozen ? frozen->end(frozen_id, k) : E.end();
+    }
+
+    unsigned int edgesNum(const DependenceEdgesT& E,
+                          typename FrozenEdgesT::Kind k) const
+    {
+        return frozen ? frozen->size(frozen_id, k) : E.size();
+    }
+
+    // use the edges packed in @F, our own containers are not needed
+    void setFrozenEdges(const FrozenEdgesT *F, uint32_t id)
+    {
+        frozen = F;
+        frozen_id = id;
+
+        ControlEdgesT().swap(controlDepEdges);
+        ControlEdgesT().swap(revControlDepEdges);
+        DependenceEdgesT().swap(dataDepEdges);
+        DependenceEdgesT().swap(revDataDepEdges);
+    }
+
+    // get back our own containers before the edges are modified
+    void thaw()
+    {
+        if (!frozen)
+            return;
+
+        const FrozenEdgesT *F = frozen;
+        frozen = nullptr;
+
+        controlDepEdges.insert(F->begin(frozen_id, FrozenEdgesT::CD),
+                               F->end(frozen_id, FrozenEdgesT::CD));
+        revControlDepEdges.insert(F->begin(frozen_id, FrozenEdgesT::REV_CD),
+                                  F->end(frozen_id, FrozenEdgesT::REV_CD));
+        dataDepEdges.insert(F->begin(frozen_id, FrozenEdgesT::DD),
+                            F->end(frozen_id, FrozenEdgesT::DD));
+        revDataDepEdges.insert(F->begin(frozen_id, FrozenEdgesT::REV_DD),
+                               F->end(frozen_id, FrozenEdgesT::REV_DD));
+    }
+
     ControlEdgesT controlDepEdges;
     DependenceEdgesT dataDepEdges;
 
@@ -356,6 +428,8 @@ private:
 
     // id of the slice this nodes is in. If it is 0, it is in no slice
     uint32_t slice_id;
+    // the index of this node in frozen
+    uint32_t frozen_id = 0;
 
 #ifdef ENABLE_CFG
     // some analyses need classical CFG edges
@@ -365,7 +439,12 @@ private:
 
     // auxiliary data for different analyses
     analysis::AnalysesAuxiliaryData analysisAuxData;
+
+    // the packed edges if the node is frozen
+    const FrozenEdgesT *frozen = nullptr;
+
     friend class analysis::Analysis<NodeT>;
+    friend class FrozenEdges<NodeT>;
 };
 
 } // namespace dg
@@ -1,6 +1,8 @@
 #ifndef _DG_ANALYSIS_H_
 #define _DG_ANALYSIS_H_
 
+#include <cstdint>
+
 namespace dg {
 
 // forward declaration of BBlock
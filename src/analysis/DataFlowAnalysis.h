@@ -2,7 +2,8 @@
 #define _DG_DATA_FLOW_ANALYSIS_H_
 
 #include <utility>
-#include <set>
+#include <vector>
+#include <unordered_map>
 
 #include "Analysis.h"
 #include "DFS.h"
@@ -16,13 +17,18 @@ namespace analysis {
 
 struct DataFlowStatistics : public AnalysisStatistics {
     DataFlowStatistics()
-        : AnalysisStatistics(), bblocksNum(0), iterationsNum(0) {}
+        : AnalysisStatistics(), bblocksNum(0), iterationsNum(0),
+          skippedBlocks(0) {}
 
     uint64_t bblocksNum;
     uint64_t iterationsNum;
+    // the blocks that were not processed again in some
+    // iteration, because none of their predecessors changed
+    uint64_t skippedBlocks;
 
     uint64_t getBBlocksNum() const { return bblocksNum; }
     uint64_t getIterationsNum() const { return iterationsNum; }
+    uint64_t getSkippedBlocksNum() const { return skippedBlocks; }
 };
 
 enum DataFlowAnalysisFlags {
@@ -46,8 +52,10 @@ class BBlockDataFlowAnalysis : public Analysis<NodeT>
 {
 public:
     BBlockDataFlowAnalysis<NodeT>(BBlock<NodeT> *entryBB, uint32_t fl = 0)
-        :entryBB(entryBB), flags(fl), changed(false) {}
+        :entryBB(entryBB), flags(fl), pending(0) {}
 
+    // return true if the block changed, so that
+    // its successors need to be processed again
     virtual bool runOnBlock(BBlock<NodeT> *BB) = 0;
 
     void run()
@@ -63,31 +71,43 @@ public:
             flg |= DFS_BB_NO_CALLSITES;
 
         BBlockDFS<NodeT> DFS(flg);
-        DFSDataT data(blocks, changed, this);
+        std::vector<BBlock<NodeT> *> found;
 
-        // we will get all the nodes using DFS
-        DFS.run(entryBB, dfs_proc_bb, data);
+        // we will get all the blocks using DFS
+        DFS.run(entryBB, dfs_proc_bb, &found);
+        setReversePostOrder(found);
 
         // update statistics
         statistics.bblocksNum = blocks.size();
-        statistics.iterationsNum = 1;
-        // first run goes over each BB once
-        statistics.processedBlocks = statistics.bblocksNum;
-
-        // Iterate over the nodes in dfs reverse order, it is
-        // usually good for reaching fixpoint. Later we can
-        // add options what ordering to use.
-        // Since we used while loop, if nothing changed after the
-        // first iteration (the DFS), the loop will never run
-        while (changed) {
-            changed = false;
-            for (auto I = blocks.rbegin(), E = blocks.rend();
-                 I != E; ++I) {
-                changed |= runOnBlock(*I);
-                ++statistics.processedBlocks;
+        statistics.iterationsNum = 0;
+        statistics.processedBlocks = 0;
+        statistics.skippedBlocks = 0;
+
+        // The first iteration goes over all blocks in reverse
+        // post-order, the next ones only over the blocks that have
+        // a changed predecessor. A block queued by a block that
+        // precedes it is processed still in the same iteration
+        queued.assign(blocks.size(), true);
+        pending = blocks.size();
+
+        while (pending > 0) {
+            uint64_t processed = 0;
+            // blocks may be added while we are iterating
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                if (!queued[i])
+                    continue;
+
+                queued[i] = false;
+                --pending;
+                ++processed;
+
+                if (runOnBlock(blocks[i]))
+                    queueSuccessors(blocks[i]);
             }
 
-            ++statistics.iterationsNum;
+            if (++statistics.iterationsNum > 1)
+                statistics.skippedBlocks += blocks.size() - processed;
+            statistics.processedBlocks += processed;
         }
     }
 
@@ -100,44 +120,143 @@ public:
 
     bool addBB(BBlock<NodeT> *BB)
     {
-        changed |= runOnBlock(BB);
-        bool ret = blocks.insert(BB).second;
-        if (ret)
+        bool changed = runOnBlock(BB);
+        bool ret = order.emplace(BB, blocks.size()).second;
+        if (ret) {
+            blocks.push_back(BB);
+            queued.push_back(false);
             ++statistics.bblocksNum;
+        }
+
+        if (changed)
+            queueSuccessors(BB);
 
-        changed |= ret;
         return ret;
     }
 
 private:
-    // define set of blocks to be ordered in dfs order
-    // FIXME if we use dfs order, then addBB does not work,
-    // because the BB's newly added does have dfsorder unset
-    // and the BlocksSet thinks it already contains it, so
-    // it is not added
-    using BlocksSetT = std::set<BBlock<NodeT> * /*,
-                     DFSOrderLess<BBlock<NodeT> *>*/>;
-    struct DFSDataT
+    // call @f on the blocks that are processed again
+    // when @BB changes (the edges that DFS takes and,
+    // if we go into procedures, the returns from them)
+    template <typename F>
+    void forEachSuccessor(BBlock<NodeT> *BB, F f)
     {
-        DFSDataT(BlocksSetT& b, bool& c, BBlockDataFlowAnalysis<NodeT> *r)
-            :blocks(b), changed(c), ref(r) {}
+        for (auto& E : BB->successors())
+            f(E.target);
+
+        if (!(flags & DATAFLOW_INTERPROCEDURAL))
+            return;
+
+        for (NodeT *cs : BB->getCallSites()) {
+            for (auto subdg : cs->getSubgraphs())
+                f(subdg->getEntryBB());
+        }
+
+        // the change of the exit of a procedure must get
+        // to the rest of the blocks that call the procedure.
+        // The exit blocks do not need to have the graph set,
+        // so take it from the exit node
+        if (BB->empty())
+            return;
 
-        BlocksSetT& blocks;
-        bool& changed;
-        BBlockDataFlowAnalysis<NodeT> *ref;
-    };
+        auto dg = BB->getLastNode()->getDG();
+        if (!dg || dg->getExitBB() != BB)
+            return;
+
+        for (NodeT *caller : dg->getCallers()) {
+            if (caller->getBBlock())
+                f(caller->getBBlock());
+        }
+    }
+
+    void queueSuccessors(BBlock<NodeT> *BB)
+    {
+        forEachSuccessor(BB, [this](BBlock<NodeT> *S) {
+            auto it = order.find(S);
+            // we process only the blocks that we know about
+            if (it == order.end() || queued[it->second])
+                return;
+
+            queued[it->second] = true;
+            ++pending;
+        });
+    }
+
+    // order the @found blocks (@found[0] is the entry)
+    // in reverse post-order and store them to blocks
+    void setReversePostOrder(const std::vector<BBlock<NodeT> *>& found)
+    {
+        std::unordered_map<BBlock<NodeT> *, size_t> idx;
+        for (size_t i = 0; i < found.size(); ++i)
+            idx.emplace(found[i], i);
+
+        std::vector<std::vector<size_t>> succs(found.size());
+        for (size_t i = 0; i < found.size(); ++i) {
+            forEachSuccessor(found[i], [&idx, &succs, i](BBlock<NodeT> *S) {
+                auto it = idx.find(S);
+                if (it != idx.end())
+                    succs[i].push_back(it->second);
+            });
+        }
+
+        std::vector<BBlock<NodeT> *> postorder;
+        postorder.reserve(found.size());
+        std::vector<bool> visited(found.size(), false);
+        // (block, index of the next successor to visit)
+        std::vector<std::pair<size_t, size_t>> stack;
+
+        for (size_t root = 0; root < found.size(); ++root) {
+            if (visited[root])
+                continue;
+
+            visited[root] = true;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                auto& top = stack.back();
+                if (top.second < succs[top.first].size()) {
+                    size_t S = succs[top.first][top.second++];
+                    if (!visited[S]) {
+                        visited[S] = true;
+                        stack.emplace_back(S, 0);
+                    }
+                } else {
+                    postorder.push_back(found[top.first]);
+                    stack.pop_back();
+                }
+            }
+        }
+
+        // keep the blocks that were added before running
+        std::vector<BBlock<NodeT> *> added;
+        for (BBlock<NodeT> *BB : blocks) {
+            if (idx.count(BB) == 0)
+                added.push_back(BB);
+        }
+
+        blocks.assign(postorder.rbegin(), postorder.rend());
+        blocks.insert(blocks.end(), added.begin(), added.end());
+
+        order.clear();
+        for (size_t i = 0; i < blocks.size(); ++i)
+            order.emplace(blocks[i], i);
+    }
 
     static void dfs_proc_bb(BBlock<NodeT> *BB,
-                            DFSDataT& data)
+                            std::vector<BBlock<NodeT> *> *found)
     {
-        data.changed |= data.ref->runOnBlock(BB);
-        data.blocks.insert(BB);
+        found->push_back(BB);
     }
 
     BBlock<NodeT> *entryBB;
-    BlocksSetT blocks;
     uint32_t flags;
-    bool changed;
+    // the blocks in reverse post-order (the blocks added
+    // by addBB() during the analysis are at the end)
+    std::vector<BBlock<NodeT> *> blocks;
+    // block -> its index in blocks
+    std::unordered_map<BBlock<NodeT> *, size_t> order;
+    // the blocks that should be processed (by the index)
+    std::vector<bool> queued;
+    size_t pending;
     DataFlowStatistics statistics;
 };
 
@@ -1,6 +1,8 @@
 #ifndef _DG_NODES_WALK_H_
 #define _DG_NODES_WALK_H_
 
+#include <atomic>
+
 #include "Analysis.h"
 #include "DGParameters.h"
 
@@ -38,13 +40,15 @@ class NodesWalkBase : public Analysis<NodeT>
 protected:
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
-    // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // that we queued a node in a particular run or not.
+    // The graphs of different modules may be walked
+    // in parallel (e.g. sliced), so the counter is atomic
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template<typename NodeT>
-unsigned int NodesWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> NodesWalkBase<NodeT>::walk_run_counter(0);
 
 template <typename NodeT, typename QueueT>
 class NodesWalk : public NodesWalkBase<NodeT>
@@ -238,13 +242,15 @@ class BBlockWalkBase : public BBlockAnalysis<NodeT>
 protected:
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
-    // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // that we queued a node in a particular run or not.
+    // The walks of different functions may run in parallel
+    // (see computeControlDependencies), so the counter is atomic
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template<typename NodeT>
-unsigned int BBlockWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> BBlockWalkBase<NodeT>::walk_run_counter(0);
 
 #ifdef ENABLE_CFG
 template <typename NodeT, typename QueueT>
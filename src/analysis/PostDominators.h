@@ -0,0 +1,262 @@
+#ifndef _DG_POST_DOMINATORS_H_
+#define _DG_POST_DOMINATORS_H_
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cassert>
+
+#include "BBlock.h"
+
+namespace dg {
+namespace analysis {
+
+///
+// Compute post-dominator tree and post-dominance frontiers
+// of blocks of one procedure
+//
+// The immediate post-dominators are computed by the iterative
+// algorithm on the reverse CFG and the frontiers are computed
+// right after them by walking up the tree from the successors
+// of branching blocks. Both are due:
+//
+// K. D. Cooper, T. J. Harvey, and K. Kennedy. 2001.
+// A Simple, Fast Dominance Algorithm.
+// Software Practice & Experience 4, 1-10.
+//
+// The root of the tree is a new (virtual) exit block that is the
+// successor of all blocks without successors. If some blocks can not
+// reach any exit (infinite loops), we add a virtual edge to the exit
+// block from one block of every such region, so all the blocks are
+// in the tree. The virtual edges are not added to the blocks.
+// Edges that lead to blocks that are not given to the analysis
+// (e.g. to other procedures) are ignored.
+//
+template <typename NodeT>
+class PostDominators
+{
+    using BlockT = BBlock<NodeT>;
+
+    // the node 0 is the virtual exit, the node i + 1 is blocks[i]
+    std::vector<BlockT *> blocks;
+    std::vector<std::vector<unsigned>> succs;
+    std::vector<std::vector<unsigned>> preds;
+    std::vector<unsigned> ipdom;
+    // the order of nodes in the post-order of DFS on the reverse CFG
+    std::vector<unsigned> po_num;
+
+    enum : unsigned { UNDEFINED = ~0U };
+
+    void addEdge(unsigned from, unsigned to)
+    {
+        succs[from].push_back(to);
+        preds[to].push_back(from);
+    }
+
+    void buildGraph()
+    {
+        std::unordered_map<BlockT *, unsigned> ids;
+        for (unsigned i = 0; i < blocks.size(); ++i)
+            ids.emplace(blocks[i], i + 1);
+
+        succs.assign(blocks.size() + 1, {});
+        preds.assign(blocks.size() + 1, {});
+
+        for (unsigned i = 0; i < blocks.size(); ++i) {
+            for (const auto& edge : blocks[i]->successors()) {
+                auto it = ids.find(edge.target);
+                if (it != ids.end())
+                    addEdge(i + 1, it->second);
+            }
+
+            if (succs[i + 1].empty())
+                addEdge(i + 1, 0);
+        }
+    }
+
+    // mark the nodes from which we can reach @n
+    void markReaching(unsigned n, std::vector<bool>& reaching)
+    {
+        std::vector<unsigned> stack{n};
+        reaching[n] = true;
+        while (!stack.empty()) {
+            unsigned cur = stack.back();
+            stack.pop_back();
+            for (unsigned p : preds[cur]) {
+                if (!reaching[p]) {
+                    reaching[p] = true;
+                    stack.push_back(p);
+                }
+            }
+        }
+    }
+
+    // return the node that is the last one discovered by DFS
+    // from @n that goes only over the nodes that do not reach the exit.
+    // That is usually the end of the infinite loop.
+    unsigned findFurthest(unsigned n, const std::vector<bool>& reaching)
+    {
+        std::vector<bool> visited(succs.size());
+        std::vector<unsigned> stack{n};
+        unsigned last = n;
+        while (!stack.empty()) {
+            unsigned cur = stack.back();
+            stack.pop_back();
+            if (visited[cur])
+                continue;
+
+            visited[cur] = true;
+            last = cur;
+            for (unsigned s : succs[cur]) {
+                if (!visited[s] && !reaching[s])
+                    stack.push_back(s);
+            }
+        }
+
+        return last;
+    }
+
+    void addVirtualExitEdges()
+    {
+        std::vector<bool> reaching(succs.size());
+        markReaching(0, reaching);
+
+        for (unsigned n = 1; n < succs.size(); ++n) {
+            if (reaching[n])
+                continue;
+
+            unsigned furthest = findFurthest(n, reaching);
+            addEdge(furthest, 0);
+            markReaching(furthest, reaching);
+        }
+    }
+
+    // number the nodes in post-order of DFS from the exit
+    // on the reverse CFG, return the nodes in reverse post-order
+    std::vector<unsigned> computeOrder()
+    {
+        std::vector<unsigned> order;
+        order.reserve(succs.size());
+        po_num.assign(succs.size(), UNDEFINED);
+
+        std::vector<bool> visited(succs.size());
+        // the node and the index of the next predecessor to visit
+        std::vector<std::pair<unsigned, unsigned>> stack{{0, 0}};
+        visited[0] = true;
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            if (top.second < preds[top.first].size()) {
+                unsigned p = preds[top.first][top.second++];
+                if (!visited[p]) {
+                    visited[p] = true;
+                    stack.emplace_back(p, 0);
+                }
+            } else {
+                po_num[top.first] = order.size();
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+
+        assert(order.size() == succs.size() && "Some nodes do not reach the exit");
+        return std::vector<unsigned>(order.rbegin(), order.rend());
+    }
+
+    unsigned intersect(unsigned a, unsigned b) const
+    {
+        while (a != b) {
+            while (po_num[a] < po_num[b])
+                a = ipdom[a];
+            while (po_num[b] < po_num[a])
+                b = ipdom[b];
+        }
+
+        return a;
+    }
+
+    void computeIPostDoms()
+    {
+        std::vector<unsigned> rpo = computeOrder();
+
+        ipdom.assign(succs.size(), UNDEFINED);
+        ipdom[0] = 0;
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (unsigned n : rpo) {
+                if (n == 0)
+                    continue;
+
+                // the successors are the predecessors in the reverse CFG
+                unsigned new_ipdom = UNDEFINED;
+                for (unsigned s : succs[n]) {
+                    if (ipdom[s] == UNDEFINED)
+                        continue;
+
+                    new_ipdom = new_ipdom == UNDEFINED ?
+                                    s : intersect(s, new_ipdom);
+                }
+
+                assert(new_ipdom != UNDEFINED);
+                if (ipdom[n] != new_ipdom) {
+                    ipdom[n] = new_ipdom;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    BlockT *getBlock(unsigned n, BlockT *root) const
+    {
+        return n == 0 ? root : blocks[n - 1];
+    }
+
+public:
+    ///
+    // Compute the post-dominator tree of the blocks from [first, last)
+    // and store it into the blocks. Also compute the post-dominance
+    // frontiers and if @add_cd is set, store them also as the control
+    // dependencies. Return the root of the tree (the virtual exit block)
+    // that the caller must delete, or nullptr if there are no blocks.
+    template <typename InputIt>
+    BlockT *compute(InputIt first, InputIt last, bool add_cd = false)
+    {
+        blocks.assign(first, last);
+        if (blocks.empty())
+            return nullptr;
+
+        buildGraph();
+        addVirtualExitEdges();
+        computeIPostDoms();
+
+        BlockT *root = new BlockT();
+        for (unsigned n = 1; n < succs.size(); ++n)
+            blocks[n - 1]->setIPostDom(getBlock(ipdom[n], root));
+
+        // the frontiers -- the node n is in the frontier of all nodes
+        // on the path in the tree from its successor to its ipdom
+        for (unsigned n = 1; n < succs.size(); ++n) {
+            BlockT *B = blocks[n - 1];
+            for (unsigned s : succs[n]) {
+                for (unsigned runner = s; runner != ipdom[n];
+                     runner = ipdom[runner]) {
+                    assert(runner != 0 && "Walked over the root");
+                    BlockT *R = blocks[runner - 1];
+                    R->addPostDomFrontier(B);
+
+                    // pd-frontiers are the reverse control dependencies
+                    if (add_cd)
+                        B->addControlDependence(R);
+                }
+            }
+        }
+
+        return root;
+    }
+};
+
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_POST_DOMINATORS_H_
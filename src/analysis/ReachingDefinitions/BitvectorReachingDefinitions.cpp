@@ -0,0 +1,232 @@
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "ReachingDefinitions.h"
+#include "BitvectorReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+static inline void setBit(std::vector<uint64_t>& bits, unsigned i)
+{
+    bits[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+}
+
+static inline bool getBit(const std::vector<uint64_t>& bits, unsigned i)
+{
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+bool BVBlock::mergeExitDefinitions(BitsT& to) const
+{
+    bool changed = false;
+    for (size_t w = 0, e = to.size(); w < e; ++w) {
+        uint64_t val = to[w] | gen[w] | (entry[w] & ~kill[w]);
+        changed |= val != to[w];
+        to[w] = val;
+    }
+
+    return changed;
+}
+
+size_t BVBlock::getReachingDefinitions(RDNode *node, RDNode *n,
+                                       const Offset& off, const Offset& len,
+                                       std::set<RDNode *>& ret)
+{
+    // the analysis is field-insensitive
+    (void) off;
+    (void) len;
+
+    // the definitions computed by the last query of this thread
+    struct QueryCache {
+        uint64_t block_uid = 0;
+        size_t idx = 0;
+        BitsT defs;
+    };
+    static thread_local QueryCache cache;
+
+    size_t idx = getNodeIndex(node);
+
+    // continue from the last query if we can
+    size_t start = 0;
+    if (cache.block_uid == getUID() && cache.idx <= idx)
+        start = cache.idx + 1;
+    else
+        cache.defs = entry;
+
+    for (size_t i = start; i <= idx; ++i)
+        rda->transfer(this, i, cache.defs);
+
+    cache.block_uid = getUID();
+    cache.idx = idx;
+
+    auto it = rda->memory_defs.find(n);
+    if (it != rda->memory_defs.end()) {
+        for (unsigned d : it->second) {
+            if (getBit(cache.defs, d))
+                ret.insert(rda->definitions[d].first);
+        }
+    }
+
+    return ret.size();
+}
+
+void BVBlock::getReachingDefinitions(RDNode *node, RDMap& ret)
+{
+    BitsT defs(entry);
+    size_t idx = getNodeIndex(node);
+    for (size_t i = 0; i <= idx; ++i)
+        rda->transfer(this, i, defs);
+
+    RDMap tmp;
+    for (unsigned d = 0; d < rda->definitions.size(); ++d) {
+        if (getBit(defs, d))
+            tmp.add(DefSite(rda->definitions[d].second),
+                    rda->definitions[d].first);
+    }
+
+    ret.swap(tmp);
+}
+
+BVReachingDefinitionsAnalysis::~BVReachingDefinitionsAnalysis()
+{
+    RDNodesBlock::releaseBlocks(blocks);
+}
+
+bool BVReachingDefinitionsAnalysis::killsWholeMemory(const DefSite& ds) const
+{
+    // we do not do strong updates on heap allocated memory,
+    // it is represented by the call site
+    if (ds.target->isUnknown() ||
+        ds.target->getType() == RDNodeType::DYN_ALLOC)
+        return false;
+
+    size_t size = ds.target->getSize();
+    return size > 0 && !ds.offset.isUnknown() && !ds.len.isUnknown()
+            && *ds.offset == 0 && *ds.len >= size;
+}
+
+void BVReachingDefinitionsAnalysis::getKilled(RDNode *n, BitsT& killed) const
+{
+    for (const DefSite& ds : n->overwrites) {
+        if (!killsWholeMemory(ds))
+            continue;
+
+        auto it = memory_defs.find(ds.target);
+        if (it == memory_defs.end())
+            continue;
+
+        for (unsigned d : it->second)
+            setBit(killed, d);
+    }
+}
+
+void BVReachingDefinitionsAnalysis::transfer(BVBlock *B, size_t idx,
+                                             BitsT& defs) const
+{
+    RDNode *n = B->nodes[idx];
+    if (!n->overwrites.empty()) {
+        BitsT killed(words_num, 0);
+        getKilled(n, killed);
+        for (size_t w = 0; w < words_num; ++w)
+            defs[w] &= ~killed[w];
+    }
+
+    for (unsigned d = B->def_begin[idx]; d < B->def_begin[idx + 1]; ++d)
+        setBit(defs, d);
+}
+
+void BVReachingDefinitionsAnalysis::numberDefinitions()
+{
+    for (auto& B : blocks) {
+        for (RDNode *n : B->nodes) {
+            B->def_begin.push_back(definitions.size());
+
+            // the def-sites are ordered by the target,
+            // so the same targets are next to each other
+            RDNode *last = nullptr;
+            for (const DefSite& ds : n->defs) {
+                if (ds.target == last)
+                    continue;
+
+                last = ds.target;
+                memory_defs[last].push_back(definitions.size());
+                definitions.emplace_back(n, last);
+            }
+        }
+
+        B->def_begin.push_back(definitions.size());
+    }
+
+    words_num = (definitions.size() + 63) / 64;
+}
+
+void BVReachingDefinitionsAnalysis::computeSummary(BVBlock *B)
+{
+    B->entry.assign(words_num, 0);
+    B->gen.assign(words_num, 0);
+    B->kill.assign(words_num, 0);
+
+    // gen = gen_2 + (gen_1 - kill_2), kill = kill_1 + kill_2
+    BitsT killed(words_num);
+    for (size_t i = 0; i < B->nodes.size(); ++i) {
+        std::fill(killed.begin(), killed.end(), 0);
+        getKilled(B->nodes[i], killed);
+
+        for (size_t w = 0; w < words_num; ++w) {
+            B->gen[w] &= ~killed[w];
+            B->kill[w] |= killed[w];
+        }
+
+        for (unsigned d = B->def_begin[i]; d < B->def_begin[i + 1]; ++d)
+            setBit(B->gen, d);
+    }
+}
+
+void BVReachingDefinitionsAnalysis::run()
+{
+    assert(root && "Do not have root");
+    assert(blocks.empty() && "Already run");
+
+    RDNodesBlock::buildBlocks(root, getNodes(root), blocks,
+                              [this]() { return new BVBlock(this); });
+    numberDefinitions();
+
+    ADT::QueueFIFO<BVBlock *> queue;
+    for (auto& B : blocks) {
+        computeSummary(B.get());
+        B->queued = true;
+        queue.push(B.get());
+    }
+
+    // do fixpoint
+    while (!queue.empty()) {
+        BVBlock *B = queue.pop();
+        B->queued = false;
+        ++statistics.processedBlocks;
+
+        bool changed = false;
+        for (RDNodesBlock *pred : B->predecessors) {
+            ++statistics.mergesNum;
+            changed |= static_cast<BVBlock *>(pred)->mergeExitDefinitions(B->entry);
+        }
+
+        if (!changed)
+            continue;
+
+        for (RDNodesBlock *S : B->successors) {
+            BVBlock *succ = static_cast<BVBlock *>(S);
+            if (!succ->queued) {
+                succ->queued = true;
+                queue.push(succ);
+            }
+        }
+    }
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
@@ -0,0 +1,113 @@
+#ifndef _DG_BITVECTOR_REACHING_DEFINITIONS_H_
+#define _DG_BITVECTOR_REACHING_DEFINITIONS_H_
+
+#include <vector>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ReachingDefinitions.h"
+#include "RDNodesBlock.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+class BVReachingDefinitionsAnalysis;
+
+/// ------------------------------------------------------------------
+// - BVBlock
+//
+//   Block of the bitvector analysis. A bit in the vectors
+//   stands for a definition, that is a pair (node, defined memory).
+/// ------------------------------------------------------------------
+class BVBlock : public RDNodesBlock
+{
+public:
+    using BitsT = std::vector<uint64_t>;
+
+private:
+    BVReachingDefinitionsAnalysis *rda;
+
+    // definitions made by nodes[i] have
+    // numbers from def_begin[i] to def_begin[i + 1]
+    std::vector<unsigned> def_begin;
+
+    // definitions that reach the first node of the block
+    BitsT entry;
+    // definitions made in the block that reach its end
+    BitsT gen;
+    // definitions killed by the nodes in the block
+    BitsT kill;
+
+    BVBlock(BVReachingDefinitionsAnalysis *rda) : rda(rda) {}
+
+public:
+    const BitsT& getEntryDefinitions() const { return entry; }
+
+    // merge the definitions that leave this block into the vector
+    bool mergeExitDefinitions(BitsT& to) const;
+
+    size_t getReachingDefinitions(RDNode *node, RDNode *n,
+                                  const Offset& off, const Offset& len,
+                                  std::set<RDNode *>& ret) override;
+    // the definitions are stored for the whole memory objects
+    void getReachingDefinitions(RDNode *node, RDMap& ret) override;
+
+    friend class BVReachingDefinitionsAnalysis;
+};
+
+///
+// Classic bitvector reaching definitions analysis. The analysis is
+// field-insensitive: all definitions of a memory object are taken
+// as definitions of the whole object and a definition kills the other
+// definitions only when it overwrites the whole object. The queries
+// on nodes ignore the offset and length and return all the definitions
+// of the memory object.
+class BVReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis
+{
+    using BitsT = BVBlock::BitsT;
+
+    std::vector<std::unique_ptr<BVBlock>> blocks;
+
+    // definition number -> (the defining node, the defined memory)
+    std::vector<std::pair<RDNode *, RDNode *>> definitions;
+    // memory -> numbers of the definitions of the memory
+    std::unordered_map<RDNode *, std::vector<unsigned>> memory_defs;
+    // the length of the bitvectors
+    size_t words_num = 0;
+
+    void numberDefinitions();
+    bool killsWholeMemory(const DefSite& ds) const;
+    void getKilled(RDNode *n, BitsT& killed) const;
+    void computeSummary(BVBlock *block);
+
+    // apply the effect of the idx-th node of block @B on the definitions
+    void transfer(BVBlock *B, size_t idx, BitsT& defs) const;
+
+public:
+    BVReachingDefinitionsAnalysis(RDNode *r,
+                                  bool field_insens = false,
+                                  Offset::type max_set_sz = Offset::UNKNOWN)
+    : ReachingDefinitionsAnalysis(r, field_insens, max_set_sz) {}
+
+    ~BVReachingDefinitionsAnalysis();
+
+    const std::vector<std::unique_ptr<BVBlock>>& getBlocks() const
+    {
+        return blocks;
+    }
+
+    size_t getDefinitionsNum() const { return definitions.size(); }
+
+    void run() override;
+
+    friend class BVBlock;
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif //  _DG_BITVECTOR_REACHING_DEFINITIONS_H_
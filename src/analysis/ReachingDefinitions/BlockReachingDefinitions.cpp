@@ -0,0 +1,139 @@
+#include <set>
+#include <vector>
+#include <cassert>
+
+#include "RDMap.h"
+#include "ReachingDefinitions.h"
+#include "BlockReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+void RDBlockSummary::computeSummary()
+{
+    gen.clear();
+    kill.clear();
+
+    for (RDNode *n : nodes) {
+        rda->transfer(n, gen);
+        kill.insert(n->overwrites.begin(), n->overwrites.end());
+    }
+}
+
+bool RDBlockSummary::mergeExitDefinitions(RDMap& to) const
+{
+    bool changed = to.merge(&gen, nullptr,
+                            rda->strong_update_unknown,
+                            rda->max_set_size);
+    // every definition that would be killed by some node
+    // in this block is killed by the union of the strong updates
+    changed |= to.merge(&entry, &kill,
+                        rda->strong_update_unknown,
+                        rda->max_set_size);
+    return changed;
+}
+
+size_t RDBlockSummary::getReachingDefinitions(RDNode *node, RDNode *n,
+                                              const Offset& off,
+                                              const Offset& len,
+                                              std::set<RDNode *>& ret)
+{
+    // the definitions computed by the last query of this thread,
+    // the queries come usually in the order of the nodes
+    struct QueryCache {
+        uint64_t block_uid = 0;
+        size_t idx = 0;
+        RDMap defs;
+    };
+    static thread_local QueryCache cache;
+
+    size_t idx = getNodeIndex(node);
+
+    // continue from the last query if we can
+    size_t start = 0;
+    if (cache.block_uid == getUID() && cache.idx <= idx) {
+        start = cache.idx + 1;
+    } else {
+        RDMap tmp(entry);
+        cache.defs.swap(tmp);
+    }
+
+    for (size_t i = start; i <= idx; ++i)
+        rda->transfer(nodes[i], cache.defs);
+
+    cache.block_uid = getUID();
+    cache.idx = idx;
+
+    return cache.defs.get(n, off, len, ret);
+}
+
+void RDBlockSummary::getReachingDefinitions(RDNode *node, RDMap& ret)
+{
+    RDMap tmp(entry);
+    ret.swap(tmp);
+
+    size_t idx = getNodeIndex(node);
+    for (size_t i = 0; i <= idx; ++i)
+        rda->transfer(nodes[i], ret);
+}
+
+BlockReachingDefinitionsAnalysis::~BlockReachingDefinitionsAnalysis()
+{
+    RDNodesBlock::releaseBlocks(blocks);
+}
+
+void BlockReachingDefinitionsAnalysis::transfer(RDNode *n, RDMap& defs) const
+{
+    // this is what processNode() does with a node that
+    // has a single predecessor
+    RDMap tmp(n->def_map);
+    tmp.merge(&defs, &n->overwrites,
+              strong_update_unknown, max_set_size,
+              false /* merge unknown */);
+    defs.swap(tmp);
+}
+
+void BlockReachingDefinitionsAnalysis::run()
+{
+    assert(root && "Do not have root");
+    assert(blocks.empty() && "Already run");
+
+    RDNodesBlock::buildBlocks(root, getNodes(root), blocks,
+                              [this]() { return new RDBlockSummary(this); });
+
+    ADT::QueueFIFO<RDBlockSummary *> queue;
+    for (auto& B : blocks) {
+        B->computeSummary();
+        B->queued = true;
+        queue.push(B.get());
+    }
+
+    // do fixpoint
+    while (!queue.empty()) {
+        RDBlockSummary *B = queue.pop();
+        B->queued = false;
+        ++statistics.processedBlocks;
+
+        bool changed = false;
+        for (RDNodesBlock *pred : B->predecessors) {
+            ++statistics.mergesNum;
+            changed |= static_cast<RDBlockSummary *>(pred)->mergeExitDefinitions(B->entry);
+        }
+
+        if (!changed)
+            continue;
+
+        for (RDNodesBlock *S : B->successors) {
+            RDBlockSummary *succ = static_cast<RDBlockSummary *>(S);
+            if (!succ->queued) {
+                succ->queued = true;
+                queue.push(succ);
+            }
+        }
+    }
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
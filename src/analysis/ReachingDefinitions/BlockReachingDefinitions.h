@@ -0,0 +1,95 @@
+#ifndef _DG_BLOCK_REACHING_DEFINITIONS_H_
+#define _DG_BLOCK_REACHING_DEFINITIONS_H_
+
+#include <vector>
+#include <memory>
+#include <set>
+
+#include "ReachingDefinitions.h"
+#include "RDMap.h"
+#include "RDNodesBlock.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+class BlockReachingDefinitionsAnalysis;
+
+/// ------------------------------------------------------------------
+// - RDBlockSummary
+//
+//   The block keeps the definitions reaching its entry and the
+//   gen/kill summary of its nodes, so that the definitions leaving
+//   the block are gen + (entry - kill). The definitions reaching
+//   a node inside the block are computed on demand from the entry map.
+/// ------------------------------------------------------------------
+class RDBlockSummary : public RDNodesBlock
+{
+    BlockReachingDefinitionsAnalysis *rda;
+
+    // definitions that reach the first node of the block
+    RDMap entry;
+    // definitions made in the block that reach its end
+    RDMap gen;
+    // definitions that are strongly updated in the block
+    DefSiteSetT kill;
+
+    RDBlockSummary(BlockReachingDefinitionsAnalysis *rda)
+    : rda(rda) {}
+
+    void computeSummary();
+
+public:
+    const RDMap& getEntryDefinitions() const { return entry; }
+    const RDMap& getGen() const { return gen; }
+    const DefSiteSetT& getKill() const { return kill; }
+
+    // merge the definitions that leave this block into the map
+    bool mergeExitDefinitions(RDMap& to) const;
+
+    size_t getReachingDefinitions(RDNode *node, RDNode *n,
+                                  const Offset& off, const Offset& len,
+                                  std::set<RDNode *>& ret) override;
+    void getReachingDefinitions(RDNode *node, RDMap& ret) override;
+
+    friend class BlockReachingDefinitionsAnalysis;
+};
+
+///
+// Reaching definitions analysis that works on straight-line
+// runs of nodes instead of single nodes. The result is the same
+// as of ReachingDefinitionsAnalysis, but the RDMaps are kept only
+// at the entries of the blocks and RDNode::def_map contains only
+// the definitions made by the node. The queries on nodes
+// (RDNode::getReachingDefinitions(n, off, len, ret)) are answered
+// on demand.
+class BlockReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis
+{
+    std::vector<std::unique_ptr<RDBlockSummary>> blocks;
+
+    // apply the effect of the node @n on the definitions @defs
+    void transfer(RDNode *n, RDMap& defs) const;
+
+public:
+    BlockReachingDefinitionsAnalysis(RDNode *r,
+                                     bool field_insens = false,
+                                     Offset::type max_set_sz = Offset::UNKNOWN)
+    : ReachingDefinitionsAnalysis(r, field_insens, max_set_sz) {}
+
+    ~BlockReachingDefinitionsAnalysis();
+
+    const std::vector<std::unique_ptr<RDBlockSummary>>& getBlocks() const
+    {
+        return blocks;
+    }
+
+    void run() override;
+
+    friend class RDBlockSummary;
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif //  _DG_BLOCK_REACHING_DEFINITIONS_H_
@@ -0,0 +1,222 @@
+#include <set>
+#include <map>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <cassert>
+
+#include "ReachingDefinitions.h"
+#include "DemandReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+size_t RDDemandBlock::getReachingDefinitions(RDNode *node, RDNode *n,
+                                             const Offset& off,
+                                             const Offset& len,
+                                             std::set<RDNode *>& ret)
+{
+    return rda->getReachingDefinitions(this, node, DefSite(n, off, len), ret);
+}
+
+void RDDemandBlock::getReachingDefinitions(RDNode *node, RDMap& ret)
+{
+    rda->getReachingDefinitions(this, node, ret);
+}
+
+DemandReachingDefinitionsAnalysis::~DemandReachingDefinitionsAnalysis()
+{
+    RDNodesBlock::releaseBlocks(blocks);
+}
+
+void DemandReachingDefinitionsAnalysis::numberDefSites()
+{
+    std::map<DefSite, unsigned> ids;
+    for (auto& B : blocks) {
+        for (RDNode *n : B->nodes) {
+            for (const DefSite& ds : n->defs) {
+                auto it = ids.emplace(ds, defsites.size());
+                if (it.second) {
+                    defsites.push_back(ds);
+                    memory_defsites[ds.target].push_back(it.first->second);
+                }
+            }
+        }
+    }
+}
+
+const RDNodesSet *
+DemandReachingDefinitionsAnalysis::findEntryDefinitions(uint64_t key)
+{
+    EntryShard& shard = getShard(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto it = shard.defs.find(key);
+    return it == shard.defs.end() ? nullptr : &it->second;
+}
+
+void DemandReachingDefinitionsAnalysis::addStatistics(const QueryStatistics& stats)
+{
+    std::lock_guard<std::mutex> guard(statistics_lock);
+    statistics.processedBlocks += stats.processedBlocks;
+    statistics.processedNodes += stats.processedNodes;
+}
+
+bool DemandReachingDefinitionsAnalysis::searchBlock(RDDemandBlock *B,
+                                                    size_t idx,
+                                                    const DefSite& ds,
+                                                    RDNodesSet& ret,
+                                                    QueryStatistics& stats)
+{
+    // this is what the merging in processNode() does with
+    // a single def-site, but backwards
+    for (size_t i = idx + 1; i > 0; --i) {
+        RDNode *n = B->nodes[i - 1];
+        ++stats.processedNodes;
+
+        if (n->defs.count(ds) > 0)
+            ret.insert(n);
+
+        if (RDMap::isOverwritten(n->overwrites, ds, strong_update_unknown))
+            return true;
+    }
+
+    return false;
+}
+
+const RDNodesSet&
+DemandReachingDefinitionsAnalysis::getEntryDefinitions(RDDemandBlock *B,
+                                                       unsigned ds_id,
+                                                       QueryStatistics& stats)
+{
+    const uint64_t key = (static_cast<uint64_t>(B->id) << 32) | ds_id;
+    if (const RDNodesSet *known = findEntryDefinitions(key))
+        return *known;
+
+    const DefSite& ds = defsites[ds_id];
+    RDNodesSet defs;
+
+    // search the predecessors backwards until the def-site
+    // is killed or we get to a block that was already searched
+    std::unordered_set<RDDemandBlock *> visited;
+    ADT::QueueLIFO<RDDemandBlock *> queue;
+    for (RDNodesBlock *pred : B->predecessors)
+        queue.push(static_cast<RDDemandBlock *>(pred));
+
+    while (!queue.empty()) {
+        RDDemandBlock *P = queue.pop();
+        if (!visited.insert(P).second)
+            continue;
+
+        ++stats.processedBlocks;
+        if (searchBlock(P, P->nodes.size() - 1, ds, defs, stats))
+            continue;
+
+        const RDNodesSet *known
+            = findEntryDefinitions((static_cast<uint64_t>(P->id) << 32) | ds_id);
+        if (known) {
+            defs.insert(*known);
+            continue;
+        }
+
+        for (RDNodesBlock *pred : P->predecessors)
+            queue.push(static_cast<RDDemandBlock *>(pred));
+    }
+
+    if (!ds.target->isUnknown() && defs.size() > max_set_size)
+        defs.makeUnknown();
+
+    // if another thread has searched the same pair meanwhile,
+    // it has found the same definitions
+    EntryShard& shard = getShard(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.defs.emplace(key, std::move(defs)).first->second;
+}
+
+void DemandReachingDefinitionsAnalysis::getDefinitions(RDDemandBlock *B,
+                                                       size_t idx,
+                                                       unsigned ds_id,
+                                                       RDNodesSet& ret,
+                                                       QueryStatistics& stats)
+{
+    const DefSite& ds = defsites[ds_id];
+    RDNodesSet defs;
+    if (!searchBlock(B, idx, ds, defs, stats))
+        defs.insert(getEntryDefinitions(B, ds_id, stats));
+
+    if (!ds.target->isUnknown() && defs.size() > max_set_size)
+        defs.makeUnknown();
+
+    ret.insert(defs);
+}
+
+size_t
+DemandReachingDefinitionsAnalysis::getReachingDefinitions(RDDemandBlock *B,
+                                                          RDNode *use,
+                                                          const DefSite& ds,
+                                                          std::set<RDNode *>& ret)
+{
+    auto it = memory_defsites.find(ds.target);
+    if (it == memory_defsites.end())
+        return ret.size();
+
+    QueryStatistics stats;
+    size_t idx = B->getNodeIndex(use);
+    for (unsigned ds_id : it->second) {
+        const DefSite& cur = defsites[ds_id];
+        // the same def-sites as RDMap::get() would take
+        if (!ds.offset.isUnknown() && !cur.offset.isUnknown() &&
+            !intervalsOverlap(*cur.offset, *cur.len, *ds.offset, *ds.len))
+            continue;
+
+        RDNodesSet defs;
+        getDefinitions(B, idx, ds_id, defs, stats);
+        ret.insert(defs.begin(), defs.end());
+    }
+
+    addStatistics(stats);
+    return ret.size();
+}
+
+void DemandReachingDefinitionsAnalysis::getReachingDefinitions(RDDemandBlock *B,
+                                                               RDNode *use,
+                                                               RDMap& ret)
+{
+    RDMap tmp;
+    QueryStatistics stats;
+    size_t idx = B->getNodeIndex(use);
+    for (unsigned ds_id = 0; ds_id < defsites.size(); ++ds_id) {
+        RDNodesSet defs;
+        getDefinitions(B, idx, ds_id, defs, stats);
+        for (RDNode *n : defs)
+            tmp.add(defsites[ds_id], n);
+    }
+
+    addStatistics(stats);
+    ret.swap(tmp);
+}
+
+size_t
+DemandReachingDefinitionsAnalysis::getReachingDefinitions(RDNode *use,
+                                                          const DefSite& ds,
+                                                          std::set<RDNode *>& ret)
+{
+    // the nodes in blocks pass the query to their block
+    return use->getReachingDefinitions(ds.target, ds.offset, ds.len, ret);
+}
+
+void DemandReachingDefinitionsAnalysis::run()
+{
+    assert(root && "Do not have root");
+    assert(blocks.empty() && "Already run");
+
+    RDNodesBlock::buildBlocks(root, getNodes(root), blocks,
+                              [this]() {
+                                  return new RDDemandBlock(this, blocks.size());
+                              });
+    numberDefSites();
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
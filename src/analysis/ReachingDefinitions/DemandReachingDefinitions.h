@@ -0,0 +1,138 @@
+#ifndef _DG_DEMAND_REACHING_DEFINITIONS_H_
+#define _DG_DEMAND_REACHING_DEFINITIONS_H_
+
+#include <vector>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#include "ReachingDefinitions.h"
+#include "RDMap.h"
+#include "RDNodesBlock.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+class DemandReachingDefinitionsAnalysis;
+
+/// ------------------------------------------------------------------
+// - RDDemandBlock
+//
+//   Block of the demand-driven analysis. It does not keep any
+//   definitions, the queries on its nodes are passed to the analysis.
+/// ------------------------------------------------------------------
+class RDDemandBlock : public RDNodesBlock
+{
+    DemandReachingDefinitionsAnalysis *rda;
+    unsigned id;
+
+    RDDemandBlock(DemandReachingDefinitionsAnalysis *rda, unsigned id)
+    : rda(rda), id(id) {}
+
+public:
+    unsigned getID() const { return id; }
+
+    size_t getReachingDefinitions(RDNode *node, RDNode *n,
+                                  const Offset& off, const Offset& len,
+                                  std::set<RDNode *>& ret) override;
+    void getReachingDefinitions(RDNode *node, RDMap& ret) override;
+
+    friend class DemandReachingDefinitionsAnalysis;
+};
+
+///
+// Reaching definitions analysis that computes nothing ahead.
+// The definitions of a def-site that reach a node are found
+// by a backward search from the node that stops on the nodes that
+// strongly update the def-site. The definitions reaching the entry
+// of a block are remembered for every searched (block, def-site) pair.
+// The results are the same as of BlockReachingDefinitionsAnalysis,
+// because the merging of RDMaps treats every def-site on its own.
+// The queries may be made from more threads at once.
+class DemandReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis
+{
+    std::vector<std::unique_ptr<RDDemandBlock>> blocks;
+
+    // the def-sites defined in the program, the index is the id
+    std::vector<DefSite> defsites;
+    // memory -> ids of the def-sites of the memory
+    std::unordered_map<RDNode *, std::vector<unsigned>> memory_defsites;
+
+    // (block id, def-site id) -> definitions reaching the block entry.
+    // The pairs are split into shards with their own locks, so that
+    // the threads that query different pairs do not wait for each other.
+    // The found sets are never changed nor removed.
+    struct EntryShard {
+        std::mutex lock;
+        std::unordered_map<uint64_t, RDNodesSet> defs;
+    };
+
+    enum { ENTRY_SHARDS = 16 };
+    EntryShard entry_defs[ENTRY_SHARDS];
+
+    EntryShard& getShard(uint64_t key)
+    {
+        return entry_defs[(key ^ (key >> 32)) % ENTRY_SHARDS];
+    }
+
+    const RDNodesSet *findEntryDefinitions(uint64_t key);
+
+    // the statistics of one query, they are added
+    // to the statistics of the analysis when the query is done
+    struct QueryStatistics {
+        uint64_t processedBlocks = 0;
+        uint64_t processedNodes = 0;
+    };
+
+    std::mutex statistics_lock;
+    void addStatistics(const QueryStatistics& stats);
+
+    void numberDefSites();
+
+    // add the definitions of @ds made by the nodes up to @idx in @B
+    // to @ret, return true if some of the nodes kills the definitions
+    // coming from the predecessors
+    bool searchBlock(RDDemandBlock *B, size_t idx, const DefSite& ds,
+                     RDNodesSet& ret, QueryStatistics& stats);
+    const RDNodesSet& getEntryDefinitions(RDDemandBlock *B, unsigned ds_id,
+                                          QueryStatistics& stats);
+    // add the definitions of the def-site @ds_id that reach
+    // the idx-th node of @B to @ret
+    void getDefinitions(RDDemandBlock *B, size_t idx, unsigned ds_id,
+                        RDNodesSet& ret, QueryStatistics& stats);
+
+    size_t getReachingDefinitions(RDDemandBlock *B, RDNode *use,
+                                  const DefSite& ds, std::set<RDNode *>& ret);
+    void getReachingDefinitions(RDDemandBlock *B, RDNode *use, RDMap& ret);
+
+public:
+    DemandReachingDefinitionsAnalysis(RDNode *r,
+                                      bool field_insens = false,
+                                      Offset::type max_set_sz = Offset::UNKNOWN)
+    : ReachingDefinitionsAnalysis(r, field_insens, max_set_sz) {}
+
+    ~DemandReachingDefinitionsAnalysis();
+
+    const std::vector<std::unique_ptr<RDDemandBlock>>& getBlocks() const
+    {
+        return blocks;
+    }
+
+    // get the definitions of the memory @ds that reach the node @use
+    // (including the definitions made by @use)
+    size_t getReachingDefinitions(RDNode *use, const DefSite& ds,
+                                  std::set<RDNode *>& ret);
+
+    void run() override;
+
+    friend class RDDemandBlock;
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif //  _DG_DEMAND_REACHING_DEFINITIONS_H_
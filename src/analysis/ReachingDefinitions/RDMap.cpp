@@ -21,6 +21,64 @@ static bool comp_ds(const DefSite& a, const DefSite& b)
     return a.target < b.target;
 }
 
+// Check whether the definitions in @no_update overwrite
+// the def-site @ds, so that the definitions of @ds are not merged.
+// @is_unknown is set to true if the definitions of @ds
+// must be kept for the unknown offset.
+static bool overwrites(const DefSiteSetT& no_update, const DefSite& ds,
+                       bool strong_update_unknown, bool& is_unknown)
+{
+    // get the writes that should overwrite this definition
+    auto range = std::equal_range(no_update.begin(), no_update.end(),
+                                  ds, comp_ds);
+
+    // if the memory is defined at unknown offset, we can
+    // still do a strong update provided this is the update
+    // of whole memory (so we need to know the size of the memory).
+    if (strong_update_unknown &&
+        is_unknown && ds.target->getSize() > 0) {
+        // XXX: we could check wether all the strong updates
+        // together overwrite the memory, but that could be
+        // to much work. Just check wether there's is just a one
+        // update that overwrites the whole memory
+        for (auto I = range.first; I!= range.second; ++I) {
+            const DefSite& ds2 = *I;
+            assert(ds.target == ds2.target);
+            if (*ds2.offset == 0 && *ds2.len >= ds.target->getSize())
+                return true;
+        }
+    } else if (ds.target->getType() != RDNodeType::DYN_ALLOC) {
+        for (auto I = range.first; I!= range.second; ++I) {
+            const DefSite& ds2 = *I;
+            assert(ds.target == ds2.target);
+            // if the 'no_update' set contains target with unknown
+            // pointer, we should always keep that value
+            // and the value being merged (just all possible definitions)
+            if (ds2.offset.isUnknown()) {
+                // do not skip, add the values for UNKNOWN to our map
+                is_unknown = true;
+                return false;
+            }
+
+            // targets are the same, check if the what we have
+            // in 'no_update' set overwrites the values that are in
+            // the other map
+            if ((*ds.offset >= *ds2.offset)
+                && (*ds.offset + *ds.len <= *ds2.offset + *ds2.len))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool RDMap::isOverwritten(const DefSiteSetT& no_update, const DefSite& ds,
+                          bool strong_update_unknown)
+{
+    bool is_unknown = ds.offset.isUnknown();
+    return overwrites(no_update, ds, strong_update_unknown, is_unknown);
+}
+
 ///
 // merge @oth map to this map. If given @no_update set,
 // take those definitions as 'overwrites'. That is -
@@ -56,7 +114,7 @@ static bool comp_ds(const DefSite& a, const DefSite& b)
 // This is useful when we have a lot of concrete and unknown definitions
 // in the map
 bool RDMap::merge(const RDMap *oth,
-                  DefSiteSetT *no_update,
+                  const DefSiteSetT *no_update,
                   bool strong_update_unknown,
                   Offset::type max_set_size,
                   bool merge_unknown)
@@ -77,68 +135,9 @@ bool RDMap::merge(const RDMap *oth,
         // Also, we don't want to do strong updates for
         // heap allocated objects, since they are all represented
         // by the call site
-        if (no_update) { // do we have anything for strong update at all?
-            // if the memory is defined at unknown offset, we can
-            // still do a strong update provided this is the update
-            // of whole memory (so we need to know the size of the memory).
-            if (strong_update_unknown &&
-                is_unknown && ds.target->getSize() > 0) {
-                // get the writes that should overwrite this definition
-                auto range = std::equal_range(no_update->begin(),
-                                              no_update->end(),
-                                              ds, comp_ds);
-                // XXX: we could check wether all the strong updates
-                // together overwrite the memory, but that could be
-                // to much work. Just check wether there's is just a one
-                // update that overwrites the whole memory
-                bool overwrites_whole_memory = false;
-                for (auto I = range.first; I!= range.second; ++I) {
-                    const DefSite& ds2 = *I;
-                    assert(ds.target == ds2.target);
-                    if (*ds2.offset == 0 && *ds2.len >= ds.target->getSize()) {
-                        overwrites_whole_memory = true;
-                        break;
-                    }
-                }
-
-                // do strong update - just continue the loop without
-                // merging this definition into our map
-                if (overwrites_whole_memory)
-                    continue;
-            } else if (ds.target->getType() != RDNodeType::DYN_ALLOC) {
-                bool skip = false;
-                auto range = std::equal_range(no_update->begin(),
-                                              no_update->end(),
-                                              ds, comp_ds);
-                for (auto I = range.first; I!= range.second; ++I) {
-                    const DefSite& ds2 = *I;
-                    assert(ds.target == ds2.target);
-                    // if the 'no_update' set contains target with unknown
-                    // pointer, we should always keep that value
-                    // and the value being merged (just all possible definitions)
-                    if (ds2.offset.isUnknown()) {
-                        // break no_update skip = true, thus adding
-                        // the values for UNKOWN to our map
-                        is_unknown = true;
-                        break;
-                    }
-
-                    // targets are the same, check if the what we have
-                    // in 'no_update' set overwrites the values that are in
-                    // the other map
-                    if ((*ds.offset >= *ds2.offset)
-                        && (*ds.offset + *ds.len <= *ds2.offset + *ds2.len)) {
-                        skip = true;
-                        break;
-                    }
-                }
-
-                // if values in 'no_update' map overwrite the coresponding values
-                // in the other map, don't update our map
-                if (skip)
-                    continue;
-            }
-        }
+        if (no_update && // do we have anything for strong update at all?
+            overwrites(*no_update, ds, strong_update_unknown, is_unknown))
+            continue;
 
         // MERGE CONCRETE OFFSETS (if desired)
         // ------------------------------------
@@ -162,8 +161,7 @@ bool RDMap::merge(const RDMap *oth,
 
                 // merge values with concrete offset to
                 // this unknown offset
-                for (RDNode *defnode : cur->second)
-                    changed |= our_vals->insert(defnode);
+                changed |= our_vals->insert(cur->second);
 
                 // erase the def-site with concrete offset
                 defs.erase(cur);
@@ -178,8 +176,7 @@ bool RDMap::merge(const RDMap *oth,
         assert(our_vals && "BUG");
 
         // copy values that have the map 'oth' for the defsite 'ds' to our map
-        for (RDNode *defnode : it.second)
-            changed |= our_vals->insert(defnode);
+        changed |= our_vals->insert(it.second);
 
         // crop the set to UNKNOWN_MEMORY if it is too big.
         // But only in the case that the  DefSite is not also UNKNOWN,
@@ -2,10 +2,12 @@
 #define _DG_DEF_MAP_H_
 
 #include <set>
+#include <cstddef>
 #include <map>
 #include <cassert>
 
 #include "analysis/Offset.h"
+#include "ADT/SortedVectorSet.h"
 
 namespace dg {
 namespace analysis {
@@ -88,10 +90,14 @@ struct DefSite
 
 extern RDNode *UNKNOWN_MEMORY;
 
-// wrapper around std::set<> with few
+// wrapper around a sorted set with few
 // improvements that will be handy in our set-up
 class RDNodesSet {
-    std::set<RDNode *> nodes;
+public:
+    using NodesT = ADT::SortedVectorSet<RDNode *>;
+
+private:
+    NodesT nodes;
     bool is_unknown;
 
 public:
@@ -117,6 +123,21 @@ public:
             return nodes.insert(n).second;
     }
 
+    // add all nodes from the other set
+    // \return true if this set changed
+    bool insert(const RDNodesSet& oth)
+    {
+        if (is_unknown)
+            return false;
+
+        if (oth.is_unknown) {
+            makeUnknown();
+            return true;
+        }
+
+        return nodes.merge(oth.nodes);
+    }
+
     size_t count(RDNode *n) const
     {
         return nodes.count(n);
@@ -138,12 +159,10 @@ public:
         return is_unknown;
     }
 
-    std::set<RDNode *>::iterator begin() { return nodes.begin(); }
-    std::set<RDNode *>::iterator end() { return nodes.end(); }
-    std::set<RDNode *>::const_iterator begin() const { return nodes.begin(); }
-    std::set<RDNode *>::const_iterator end() const { return nodes.end(); }
+    NodesT::const_iterator begin() const { return nodes.begin(); }
+    NodesT::const_iterator end() const { return nodes.end(); }
 
-    std::set<RDNode *>& getNodes()
+    const NodesT& getNodes() const
     {
         return nodes;
     };
@@ -163,13 +182,20 @@ public:
     RDMap(const RDMap& o);
 
     bool merge(const RDMap *o,
-               DefSiteSetT *without = nullptr,
+               const DefSiteSetT *without = nullptr,
                bool strong_update_unknown = true,
                Offset::type max_set_size  = Offset::UNKNOWN,
                bool merge_unknown     = false);
+    // would the definitions of @ds be killed when merging
+    // with the strong updates @no_update? (see merge())
+    static bool isOverwritten(const DefSiteSetT& no_update, const DefSite& ds,
+                              bool strong_update_unknown);
     bool add(const DefSite&, RDNode *n);
     bool update(const DefSite&, RDNode *n);
     bool empty() const { return defs.empty(); }
+    size_t size() const { return defs.size(); }
+    void clear() { defs.clear(); }
+    void swap(RDMap& oth) { defs.swap(oth.defs); }
 
     // @return iterators for the range of pointers that has the same object
     // as the given def site
@@ -0,0 +1,140 @@
+#ifndef _DG_RD_NODES_BLOCK_H_
+#define _DG_RD_NODES_BLOCK_H_
+
+#include <vector>
+#include <memory>
+#include <set>
+#include <atomic>
+#include <cstdint>
+#include <cassert>
+
+#include "ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+/// ------------------------------------------------------------------
+// - RDNodesBlock
+//
+//   Straight-line run of RDNodes: every node but the first has just
+//   one predecessor, every node but the last has just one successor.
+//   The analyses that keep the reaching definitions only for blocks
+//   set RDNode::nodes_block and answer the queries on the nodes
+//   on demand.
+/// ------------------------------------------------------------------
+class RDNodesBlock
+{
+    // the ids are never reused, so the caches of queries
+    // can not mistake a new block for a deleted one
+    const uint64_t uid;
+
+    static uint64_t newUID()
+    {
+        static std::atomic<uint64_t> last(0);
+        return ++last;
+    }
+
+protected:
+    std::vector<RDNode *> nodes;
+    std::vector<RDNodesBlock *> successors;
+    std::vector<RDNodesBlock *> predecessors;
+
+    // the block is in the worklist of the analysis
+    bool queued = false;
+
+    static bool isBlockStart(RDNode *root, RDNode *n)
+    {
+        if (n == root || n->getPredecessors().size() != 1)
+            return true;
+
+        RDNode *pred = n->getPredecessors()[0];
+        return pred == n || pred->getSuccessors().size() != 1;
+    }
+
+public:
+    RDNodesBlock() : uid(newUID()) {}
+    virtual ~RDNodesBlock() = default;
+
+    uint64_t getUID() const { return uid; }
+
+    const std::vector<RDNode *>& getNodes() const { return nodes; }
+    const std::vector<RDNodesBlock *>& getSuccessors() const { return successors; }
+    const std::vector<RDNodesBlock *>& getPredecessors() const { return predecessors; }
+
+    size_t getNodeIndex(RDNode *n) const
+    {
+        assert(n->nodes_block == this && nodes[n->block_idx] == n
+               && "The node is not in this block");
+        return n->block_idx;
+    }
+
+    // get definitions of memory [n + off, n + off + len]
+    // that reach the @node (including the definitions made by @node)
+    virtual size_t getReachingDefinitions(RDNode *node, RDNode *n,
+                                          const Offset& off, const Offset& len,
+                                          std::set<RDNode *>& ret) = 0;
+
+    // store all the definitions that reach the @node
+    // (including the definitions made by @node) into @ret
+    virtual void getReachingDefinitions(RDNode *node, RDMap& ret) = 0;
+
+    // split the @nodes (reachable from @root) into blocks,
+    // @create returns a new empty block
+    template <typename BlockT, typename CreateT>
+    static void buildBlocks(RDNode *root, const std::vector<RDNode *>& nodes,
+                            std::vector<std::unique_ptr<BlockT>>& blocks,
+                            CreateT create)
+    {
+        for (RDNode *n : nodes) {
+            if (!isBlockStart(root, n))
+                continue;
+
+            BlockT *block = create();
+            blocks.emplace_back(block);
+
+            RDNode *cur = n;
+            while (true) {
+                cur->nodes_block = block;
+                cur->block_idx = block->nodes.size();
+                block->nodes.push_back(cur);
+
+                if (cur->getSuccessors().size() != 1)
+                    break;
+
+                cur = cur->getSuccessors()[0];
+                if (isBlockStart(root, cur))
+                    break;
+            }
+        }
+
+        // the successors of the last node are starts of blocks
+        for (auto& B : blocks) {
+            for (RDNode *succ : B->nodes.back()->getSuccessors()) {
+                RDNodesBlock *succB = succ->nodes_block;
+                assert(succB && succB->nodes[0] == succ);
+
+                B->successors.push_back(succB);
+                succB->predecessors.push_back(B.get());
+            }
+        }
+    }
+
+    // the nodes may outlive the blocks
+    template <typename BlockT>
+    static void releaseBlocks(std::vector<std::unique_ptr<BlockT>>& blocks)
+    {
+        for (auto& B : blocks) {
+            for (RDNode *n : B->nodes)
+                n->nodes_block = nullptr;
+        }
+
+        blocks.clear();
+    }
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif //  _DG_RD_NODES_BLOCK_H_
@@ -1,7 +1,12 @@
 #include <set>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <functional>
 
 #include "RDMap.h"
 #include "ReachingDefinitions.h"
+#include "RDNodesBlock.h"
 
 namespace dg {
 namespace analysis {
@@ -10,6 +15,29 @@ namespace rd {
 RDNode UNKNOWN_MEMLOC;
 RDNode *UNKNOWN_MEMORY = &UNKNOWN_MEMLOC;
 
+size_t RDNode::getReachingDefinitions(RDNode *n, const Offset& off,
+                                      const Offset& len,
+                                      std::set<RDNode *>& ret)
+{
+    // the block-level analyses have the definitions only
+    // at the entry of the block, the rest is computed on demand
+    if (nodes_block)
+        return nodes_block->getReachingDefinitions(this, n, off, len, ret);
+
+    return def_map.get(n, off, len, ret);
+}
+
+void RDNode::getReachingDefinitions(RDMap& ret)
+{
+    if (nodes_block) {
+        nodes_block->getReachingDefinitions(this, ret);
+        return;
+    }
+
+    RDMap tmp(def_map);
+    ret.swap(tmp);
+}
+
 bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
 {
     bool changed = false;
@@ -26,10 +54,127 @@ bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
     return changed;
 }
 
+std::vector<RDNode *> ReachingDefinitionsAnalysis::getNodesRPO()
+{
+    assert(root && "Do not have root");
+
+    ++dfsnum;
+
+    std::vector<RDNode *> postorder;
+    // the node and the index of its next successor to visit
+    std::vector<std::pair<RDNode *, size_t>> stack;
+    stack.emplace_back(root, 0);
+    root->dfsid = dfsnum;
+
+    while (!stack.empty()) {
+        RDNode *cur = stack.back().first;
+        size_t& succ_idx = stack.back().second;
+
+        if (succ_idx < cur->successors.size()) {
+            RDNode *succ = cur->successors[succ_idx++];
+            if (succ->dfsid != dfsnum) {
+                succ->dfsid = dfsnum;
+                stack.emplace_back(succ, 0);
+            }
+        } else {
+            postorder.push_back(cur);
+            stack.pop_back();
+        }
+    }
+
+    return std::vector<RDNode *>(postorder.rbegin(), postorder.rend());
+}
+
 void ReachingDefinitionsAnalysis::run()
 {
     assert(root && "Do not have root");
 
+    std::vector<RDNode *> rpo = getNodesRPO();
+    const unsigned nodes_num = rpo.size();
+    const unsigned NOT_REACHABLE = ~static_cast<unsigned>(0);
+
+    std::unordered_map<RDNode *, unsigned> rpo_idx;
+    rpo_idx.reserve(nodes_num);
+    for (unsigned i = 0; i < nodes_num; ++i)
+        rpo_idx[rpo[i]] = i;
+
+    // the version of a node is increased every time
+    // its map changes. For every predecessor edge we keep
+    // the version of the predecessor that we merged the last time.
+    // The predecessors that are not reachable from the root never
+    // change, they have always the version 1.
+    std::vector<unsigned> version(nodes_num, 1);
+    std::vector<std::vector<unsigned>> preds(nodes_num);
+    std::vector<std::vector<unsigned>> merged(nodes_num);
+    std::vector<std::vector<unsigned>> succs(nodes_num);
+    for (unsigned i = 0; i < nodes_num; ++i) {
+        for (RDNode *pred : rpo[i]->predecessors) {
+            auto it = rpo_idx.find(pred);
+            preds[i].push_back(it == rpo_idx.end() ? NOT_REACHABLE : it->second);
+        }
+
+        merged[i].resize(preds[i].size(), 0);
+
+        for (RDNode *succ : rpo[i]->successors)
+            succs[i].push_back(rpo_idx[succ]);
+    }
+
+    // the worklist is ordered by the reverse post-order
+    std::priority_queue<unsigned, std::vector<unsigned>,
+                        std::greater<unsigned>> worklist;
+    std::vector<bool> queued(nodes_num, true);
+    for (unsigned i = 0; i < nodes_num; ++i)
+        worklist.push(i);
+
+    unsigned last = NOT_REACHABLE;
+    while (!worklist.empty()) {
+        unsigned i = worklist.top();
+        worklist.pop();
+        queued[i] = false;
+
+        // we went back in the order, this is a new pass over the nodes
+        if (last == NOT_REACHABLE || i <= last)
+            ++statistics.iterationsNum;
+        last = i;
+        ++statistics.processedNodes;
+
+        RDNode *node = rpo[i];
+        bool changed = false;
+        for (unsigned k = 0; k < preds[i].size(); ++k) {
+            unsigned pred_version
+                = preds[i][k] == NOT_REACHABLE ? 1 : version[preds[i][k]];
+            if (merged[i][k] == pred_version) {
+                ++statistics.skippedMergesNum;
+                continue;
+            }
+
+            merged[i][k] = pred_version;
+            ++statistics.mergesNum;
+            changed |= node->def_map.merge(&node->predecessors[k]->def_map,
+                                           &node->overwrites /* strong update */,
+                                           strong_update_unknown,
+                                           max_set_size /* max size of set of reaching definition
+                                                           of one definition site */,
+                                           false /* merge unknown */);
+        }
+
+        if (!changed)
+            continue;
+
+        ++version[i];
+        for (unsigned succ : succs[i]) {
+            if (!queued[succ]) {
+                queued[succ] = true;
+                worklist.push(succ);
+            }
+        }
+    }
+}
+
+void RoundsReachingDefinitionsAnalysis::run()
+{
+    assert(root && "Do not have root");
+
     std::vector<RDNode *> to_process = getNodes(root);
     std::vector<RDNode *> changed;
 
@@ -38,7 +183,11 @@ void ReachingDefinitionsAnalysis::run()
         unsigned last_processed_num = to_process.size();
         changed.clear();
 
+        ++statistics.iterationsNum;
         for (RDNode *cur : to_process) {
+            ++statistics.processedNodes;
+            statistics.mergesNum += cur->getPredecessors().size();
+
             if (processNode(cur))
                 changed.push_back(cur);
         }
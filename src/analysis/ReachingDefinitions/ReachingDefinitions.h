@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstring>
 
+#include "analysis/Analysis.h"
 #include "analysis/SubgraphNode.h"
 #include "analysis/PointsTo/PointerSubgraph.h"
 #include "analysis/Offset.h"
@@ -31,6 +32,7 @@ namespace srg {
 
 class RDNode;
 class ReachingDefinitionsAnalysis;
+class RDNodesBlock;
 
 // here the types are for type-checking (optional - user can do it
 // when building the graph) and for later optimizations
@@ -64,6 +66,11 @@ class RDNode : public SubgraphNode<RDNode> {
     BBlock<RDNode> *bblock = nullptr;
     // marks for DFS/BFS
     unsigned int dfsid;
+    // set by the block-level analyses, the node then
+    // does not keep its reaching definitions in def_map
+    RDNodesBlock *nodes_block = nullptr;
+    // the index of the node in nodes_block
+    unsigned block_idx = 0;
 public:
 
     RDNode(RDNodeType t = RDNodeType::NONE)
@@ -186,10 +193,10 @@ public:
     const RDMap& getReachingDefinitions() const { return def_map; }
     RDMap& getReachingDefinitions() { return def_map; }
     size_t getReachingDefinitions(RDNode *n, const Offset& off,
-                                  const Offset& len, std::set<RDNode *>& ret)
-    {
-        return def_map.get(n, off, len, ret);
-    }
+                                  const Offset& len, std::set<RDNode *>& ret);
+    // store all the definitions reaching this node into @ret,
+    // unlike def_map this works also with the block-level analyses
+    void getReachingDefinitions(RDMap& ret);
 
     bool isUnknown() const
     {
@@ -235,9 +242,29 @@ public:
     }
 
     friend class ReachingDefinitionsAnalysis;
+    friend class RDNodesBlock;
     friend class dg::analysis::rd::srg::AssignmentFinder;
 };
 
+struct ReachingDefinitionsStatistics : public AnalysisStatistics
+{
+    ReachingDefinitionsStatistics()
+        : AnalysisStatistics(), iterationsNum(0),
+          mergesNum(0), skippedMergesNum(0) {}
+
+    // number of passes over the nodes
+    uint64_t iterationsNum;
+    // number of merged maps of predecessors
+    uint64_t mergesNum;
+    // number of predecessors that were not merged,
+    // because they did not change since the last visit
+    uint64_t skippedMergesNum;
+
+    uint64_t getIterationsNum() const { return iterationsNum; }
+    uint64_t getMergesNum() const { return mergesNum; }
+    uint64_t getSkippedMergesNum() const { return skippedMergesNum; }
+};
+
 class ReachingDefinitionsAnalysis
 {
 protected:
@@ -246,6 +273,8 @@ protected:
     bool strong_update_unknown;
     uint32_t max_set_size;
 
+    ReachingDefinitionsStatistics statistics;
+
 public:
     ReachingDefinitionsAnalysis(RDNode *r,
                                 bool field_insens = false,
@@ -327,15 +356,39 @@ public:
     }
 
 
+    // get nodes reachable from the root in reverse post-order
+    std::vector<RDNode *> getNodesRPO();
+
     RDNode *getRoot() const { return root; }
     void setRoot(RDNode *r) { root = r; }
 
+    const ReachingDefinitionsStatistics& getStatistics() const
+    {
+        return statistics;
+    }
+
     bool processNode(RDNode *n);
     virtual void run();
 
     virtual ~ReachingDefinitionsAnalysis() = default;
 };
 
+///
+// The dense analysis that processes all the nodes reachable from
+// the changed nodes in rounds until the fixpoint is reached.
+// The results are the same as of ReachingDefinitionsAnalysis,
+// it is kept to compare the number of iterations.
+class RoundsReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis
+{
+public:
+    RoundsReachingDefinitionsAnalysis(RDNode *r,
+                                      bool field_insens = false,
+                                      Offset::type max_set_sz = Offset::UNKNOWN)
+    : ReachingDefinitionsAnalysis(r, field_insens, max_set_sz) {}
+
+    void run() override;
+};
+
 } // namespace rd
 } // namespace analysis
 } // namespace dg
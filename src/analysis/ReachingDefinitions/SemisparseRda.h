@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <cassert>
+
+#include "BBlock.h"
+#include "ADT/Queue.h"
+#include "analysis/BFS.h"
 #include "analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "analysis/ReachingDefinitions/Srg/SparseRDGraphBuilder.h"
 #include "analysis/ReachingDefinitions/Srg/MarkerSRGBuilderFS.h"
@@ -17,60 +23,101 @@ private:
     using SrgBuilder = dg::analysis::rd::srg::MarkerSRGBuilderFS;
     using SparseRDGraph = dg::analysis::rd::srg::SparseRDGraph;
 
-    bool merge_maps(RDNode *source, RDNode *dest, DefSite& var) {
+    // propagate the definitions of the variable @var from @source to @dest
+    bool merge_maps(RDNode *source, RDNode *dest, const DefSite& var) {
         bool changed = false;
 
         if (source->getType() != RDNodeType::PHI)
             changed |= dest->def_map.add(var, source);
 
-        for (auto& pair : source->def_map) {
-            const DefSite& ds = pair.first;
-            auto& nodes = pair.second;
-
-            if (ds.target == var.target) {
-                for (RDNode *node : nodes) {
-                    if (node->getType() != RDNodeType::PHI)
-                        changed |= dest->def_map.add(ds, node);
-                }
+        // the def map is ordered by the target, so we can
+        // visit only the sub-map of the propagated variable
+        // (the smallest valid def-site of the target is [0, 1))
+        const auto& defs = source->def_map.getDefs();
+        for (auto I = defs.lower_bound(DefSite(var.target, 0, 1));
+             I != defs.end() && I->first.target == var.target; ++I) {
+            const DefSite& ds = I->first;
+
+            for (RDNode *node : I->second) {
+                if (node->getType() != RDNodeType::PHI)
+                    changed |= dest->def_map.add(ds, node);
             }
         }
+
         return changed;
     }
 
+    // get the sources of the sparse graph in a deterministic order:
+    // the nodes in the order of the basic blocks, then the phi nodes
+    std::vector<RDNode *> getSourcesOrdered() {
+        std::vector<RDNode *> sources;
+        sources.reserve(srg.size());
+
+        std::unordered_set<RDNode *> added;
+        auto addSource = [&](RDNode *n) {
+            if (srg.count(n) > 0 && added.insert(n).second)
+                sources.push_back(n);
+        };
+
+        BBlockBFS<RDNode> bfs(BFS_BB_CFG | BFS_INTERPROCEDURAL);
+        bfs.run(root->getBBlock(), [&](BBlock<RDNode> *block, void *) {
+            for (RDNode *n : block->getNodes())
+                addSource(n);
+        }, nullptr);
+
+        for (auto& phi : phi_nodes)
+            addSource(phi.get());
+
+        // the rest (if any) should not depend on the order
+        for (auto& pair : srg)
+            addSource(pair.first);
+
+        return sources;
+    }
+
     SrgBuilder srg_builder;
     SparseRDGraph srg;
     std::vector<std::unique_ptr<RDNode>> phi_nodes;
 
 public:
-    SemisparseRda(RDNode *root) : ReachingDefinitionsAnalysis(root) {}
+    // @threads - number of threads used to build the sparse graph
+    // (0 means all hardware threads)
+    SemisparseRda(RDNode *root, unsigned threads = 1)
+    : ReachingDefinitionsAnalysis(root), srg_builder(threads) {}
 
     void run() override {
-        std::unordered_set<RDNode *> to_process;
         std::tie(srg, phi_nodes) = srg_builder.build(root);
 
+        ADT::QueueFIFO<RDNode *> to_process;
+        std::unordered_set<RDNode *> queued;
+
         // add all sources to @to_process
-        for (auto& pair : srg) {
-            RDNode *source = pair.first;
-            to_process.insert(source);
+        for (RDNode *source : getSourcesOrdered()) {
+            to_process.push(source);
+            queued.insert(source);
         }
 
         // do fixpoint
         while (!to_process.empty()) {
-            auto it = to_process.begin();
+            RDNode *source = to_process.pop();
+            queued.erase(source);
+            ++statistics.processedNodes;
 
-            RDNode *source = *it;
-            to_process.erase(it);
+            auto it = srg.find(source);
+            if (it == srg.end())
+                continue;
 
-            for (auto& pair : srg[source]) {
+            for (auto& pair : it->second) {
                 // variable to propagate
-                DefSite var = pair.first;
+                const DefSite& var = pair.first;
                 // where to propagate
                 RDNode *dest = pair.second;
 
+                ++statistics.mergesNum;
                 if (merge_maps(source, dest, var)) {
                     // if dest does not define this variable, it is unnecessary to process it again
-                    if (dest->defines(var.target)) {
-                        to_process.insert(dest);
+                    if (dest->defines(var.target) && queued.insert(dest).second) {
+                        to_process.push(dest);
                     }
                 }
             }
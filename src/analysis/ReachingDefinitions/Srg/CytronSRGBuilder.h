@@ -7,6 +7,7 @@
 #include <stack>
 
 #include "analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/Srg/SparseRDGraphBuilder.h"
 #include "analysis/ReachingDefinitions/Srg/PhiPlacement.h"
 
 namespace dg {
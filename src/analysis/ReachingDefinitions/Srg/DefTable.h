@@ -0,0 +1,109 @@
+#ifndef _DG_SRG_DEFTABLE_H_
+#define _DG_SRG_DEFTABLE_H_
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cassert>
+
+namespace dg {
+namespace analysis {
+namespace rd {
+namespace srg {
+namespace detail {
+
+/**
+ * Table mapping pairs (variable id, block id) to values.
+ * It is an open-addressing hash table with linear probing,
+ * the values are stored in a deque, so the references to them
+ * stay valid when new values are added.
+ * Looking up a missing pair does not insert anything.
+ */
+template <typename V>
+class DefTable {
+    static const uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+    // keys and indices of values, the size is a power of two
+    std::vector<uint64_t> keys;
+    std::vector<unsigned> slots;
+    std::deque<V> values;
+
+    static uint64_t makeKey(unsigned var, unsigned block) {
+        return (static_cast<uint64_t>(var) << 32) | block;
+    }
+
+    size_t getSlot(uint64_t key) const {
+        assert(!keys.empty());
+        const size_t mask = keys.size() - 1;
+        // Fibonacci hashing
+        size_t i = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        while (keys[i] != EMPTY && keys[i] != key)
+            i = (i + 1) & mask;
+
+        return i;
+    }
+
+    void grow() {
+        std::vector<uint64_t> old_keys(keys.empty() ? 16 : 2 * keys.size(), EMPTY);
+        std::vector<unsigned> old_slots(old_keys.size());
+        old_keys.swap(keys);
+        old_slots.swap(slots);
+
+        for (size_t i = 0; i < old_keys.size(); ++i) {
+            if (old_keys[i] == EMPTY)
+                continue;
+
+            size_t slot = getSlot(old_keys[i]);
+            keys[slot] = old_keys[i];
+            slots[slot] = old_slots[i];
+        }
+    }
+
+public:
+    // return the value for the pair or nullptr if there is none
+    V *find(unsigned var, unsigned block) {
+        if (values.empty())
+            return nullptr;
+
+        size_t slot = getSlot(makeKey(var, block));
+        if (keys[slot] == EMPTY)
+            return nullptr;
+
+        return &values[slots[slot]];
+    }
+
+    // return the value for the pair, create it if there is none
+    V& get(unsigned var, unsigned block) {
+        // keep the load factor under 1/2
+        if (2 * (values.size() + 1) > keys.size())
+            grow();
+
+        const uint64_t key = makeKey(var, block);
+        size_t slot = getSlot(key);
+        if (keys[slot] == EMPTY) {
+            keys[slot] = key;
+            slots[slot] = values.size();
+            values.emplace_back();
+        }
+
+        return values[slots[slot]];
+    }
+
+    size_t size() const { return values.size(); }
+
+    void clear() {
+        keys.clear();
+        slots.clear();
+        values.clear();
+    }
+};
+
+template <typename V>
+const uint64_t DefTable<V>::EMPTY;
+
+}
+}
+}
+}
+}
+#endif /* _DG_SRG_DEFTABLE_H_ */
@@ -1,6 +1,12 @@
 #ifndef _DG_INTERVALSET_H
 #define _DG_INTERVALSET_H
 
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
 #include "analysis/Offset.h"
 #include "analysis/ReachingDefinitions/RDMap.h"
 
@@ -67,8 +73,21 @@ public:
 
 };
 
+/**
+ * Set of disjoint intervals sorted by their starts.
+ * Overlapping and adjacent intervals are united on insertion,
+ * so an interval is covered by the set iff it is a subset
+ * of a single interval from the set.
+ */
 class DisjointIntervalSet {
     std::vector<Interval> intervals;
+    // intervals that cannot be united with anything
+    std::vector<Interval> unknown;
+
+    static bool startsBefore(const Interval& a, const Interval& b) {
+        return a.getStart() < b.getStart();
+    }
+
 public:
 
     DisjointIntervalSet() { }
@@ -81,20 +100,46 @@ public:
     }
 
     void insert(Interval interval) {
-        // find & remove all overlapping intervals
-        for (auto it = begin(); it != end(); ) {
-            if (interval.unite(*it)) {
-                it = intervals.erase(it);
-            } else {
-                ++it;
-            }
+        if (interval.isUnknown()) {
+            unknown.push_back(std::move(interval));
+            return;
         }
 
-        intervals.push_back(std::move(interval));
+        // the intervals that can be united with @interval
+        // form a contiguous range, the first one may start before it
+        auto first = std::upper_bound(intervals.begin(), intervals.end(),
+                                      interval, startsBefore);
+        if (first != intervals.begin() && interval.unite(*(first - 1)))
+            --first;
+
+        auto last = first;
+        while (last != intervals.end() && interval.unite(*last))
+            ++last;
+
+        first = intervals.erase(first, last);
+        intervals.insert(first, std::move(interval));
     }
 
-    auto cbegin() const -> decltype(intervals.begin()) {
-        return intervals.begin();
+    /**
+     * Returns true if @interval is subset of union of intervals in this set
+     */
+    bool isCovered(const Interval& interval) const {
+        // it could be, that would be an under-approximation
+        if (interval.isUnknown()) {
+            return true;
+        }
+
+        auto it = std::upper_bound(intervals.begin(), intervals.end(),
+                                   interval, startsBefore);
+        if (it == intervals.begin())
+            return false;
+
+        --it;
+        return interval.overlaps(*it) && interval.isSubsetOf(*it);
+    }
+
+    auto cbegin() const -> decltype(intervals.cbegin()) {
+        return intervals.cbegin();
     }
 
     auto begin() -> decltype(intervals.begin()) {
@@ -110,14 +155,18 @@ public:
     }
 
     auto size() -> decltype(intervals.size()) {
-        return intervals.size();
+        return intervals.size() + unknown.size();
     }
 
-    const std::vector<Interval>& toVector() const {
-        return intervals;
+    std::vector<Interval> toVector() const {
+        std::vector<Interval> ret(intervals);
+        ret.insert(ret.end(), unknown.begin(), unknown.end());
+        return ret;
     }
 
-    std::vector<Interval>&& moveVector() {
+    std::vector<Interval> moveVector() {
+        intervals.insert(intervals.end(), unknown.begin(), unknown.end());
+        unknown.clear();
         return std::move(intervals);
     }
 };
@@ -136,24 +185,144 @@ class IntervalMap {
 
     std::vector<std::pair<Interval, V>> buckets;
 
-    /**
-     * Returns true if @interval is subset of union of intervals in @intervals
+    /*
+     * The known intervals are indexed by a treap (a randomized search tree)
+     * ordered by the start of the intervals. Every node keeps the maximal
+     * end of the intervals in its subtree, so the intervals that overlap
+     * a given interval are found in O(log n + k).
+     * Node i of the tree is the bucket i, the intervals with unknown
+     * offset or zero length are kept aside, they match everything.
      */
-    static inline bool isCovered(const Interval& interval, const DisjointIntervalSet& intervals) {
-        // it could be, that would be an under-approximation
-        if (interval.isUnknown()) {
-            return true;
+    static const size_t NONE = ~static_cast<size_t>(0);
+
+    struct TreeNode {
+        Offset::type start;
+        Offset::type end;
+        // maximal end in the subtree
+        Offset::type max_end;
+        uint32_t priority;
+        size_t left = NONE;
+        size_t right = NONE;
+
+        TreeNode(Offset::type s, Offset::type e, uint32_t p)
+        : start(s), end(e), max_end(e), priority(p) {}
+    };
+
+    std::vector<TreeNode> tree;
+    size_t tree_root = NONE;
+    // indices of buckets with unknown intervals
+    std::vector<size_t> unknown;
+    // state of the generator of priorities,
+    // fixed seed keeps the tree deterministic
+    uint32_t seed = 2463534242u;
+
+    uint32_t nextPriority() {
+        // xorshift32
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    void updateMaxEnd(size_t n) {
+        TreeNode& node = tree[n];
+        node.max_end = node.end;
+        if (node.left != NONE && tree[node.left].max_end > node.max_end)
+            node.max_end = tree[node.left].max_end;
+        if (node.right != NONE && tree[node.right].max_end > node.max_end)
+            node.max_end = tree[node.right].max_end;
+    }
+
+    // split the subtree @t to nodes with smaller starts than @start
+    // and the rest
+    void split(size_t t, Offset::type start, size_t& l, size_t& r) {
+        if (t == NONE) {
+            l = r = NONE;
+        } else if (tree[t].start < start) {
+            split(tree[t].right, start, tree[t].right, r);
+            l = t;
+            updateMaxEnd(t);
+        } else {
+            split(tree[t].left, start, l, tree[t].left);
+            r = t;
+            updateMaxEnd(t);
         }
-        for (auto it = intervals.cbegin(); it != intervals.cend(); ++it) {
-            if (interval.overlaps(*it) && interval.isSubsetOf(*it)) {
-                return true;
-            }
+    }
+
+    size_t insertNode(size_t t, size_t n) {
+        if (t == NONE)
+            return n;
+
+        if (tree[n].priority > tree[t].priority) {
+            split(t, tree[n].start, tree[n].left, tree[n].right);
+            updateMaxEnd(n);
+            return n;
         }
-        return false;
+
+        if (tree[n].start < tree[t].start)
+            tree[t].left = insertNode(tree[t].left, n);
+        else
+            tree[t].right = insertNode(tree[t].right, n);
+
+        updateMaxEnd(t);
+        return t;
+    }
+
+    // gather indices of buckets whose intervals overlap [start, end)
+    void findOverlapping(size_t t, Offset::type start, Offset::type end,
+                         std::vector<size_t>& ret) const {
+        while (t != NONE && tree[t].max_end > start) {
+            const TreeNode& node = tree[t];
+            findOverlapping(node.left, start, end, ret);
+
+            // the nodes on the right start even later
+            if (node.start >= end)
+                return;
+
+            if (node.end > start)
+                ret.push_back(t);
+
+            t = node.right;
+        }
+    }
+
+    /*
+     * Returns the indices of buckets that overlap @interval
+     * (or that have unknown interval) from the latest to the oldest
+     */
+    std::vector<size_t> getCandidates(const Interval& interval) const {
+        std::vector<size_t> ret;
+        if (interval.isUnknown()) {
+            ret.reserve(buckets.size());
+            for (size_t i = buckets.size(); i > 0; --i)
+                ret.push_back(i - 1);
+            return ret;
+        }
+
+        const Offset::type start = *interval.getStart();
+        const Offset::type end = *(interval.getStart() + interval.getLength());
+        findOverlapping(tree_root, start, end, ret);
+        ret.insert(ret.end(), unknown.begin(), unknown.end());
+
+        std::sort(ret.begin(), ret.end(), std::greater<size_t>());
+        return ret;
     }
 
 public:
     void add(Interval&& interval, const V& value) {
+        const size_t idx = buckets.size();
+        if (interval.isUnknown()) {
+            unknown.push_back(idx);
+            // placeholder, it is not linked into the tree
+            tree.emplace_back(Offset::UNKNOWN, 0, 0);
+        } else {
+            // the end can be unknown, then it is the maximal value
+            const Offset::type end
+                = *(interval.getStart() + interval.getLength());
+            tree.emplace_back(*interval.getStart(), end, nextPriority());
+            tree_root = insertNode(tree_root, idx);
+        }
+
         //                                    move interval, copy value
         auto to_add = std::make_pair<Interval, V>(std::move(interval), V(value));
         buckets.push_back(std::move(to_add));
@@ -162,7 +331,8 @@ public:
     /**
      * Returns set of values such, that @interval is subset of union of all their key intervals.
      * If ReverseLookup, then searching starts at the end of IntervalMap.
-     * Searching stops as soon as satisfying set is found
+     * A value is returned only when its key interval is not covered by the
+     * key intervals of the later returned values (and by @covered).
      *
      * Return Tuple:
      *      0 - values associated with key intervals
@@ -174,18 +344,20 @@ public:
 
         std::vector<V> result;
         DisjointIntervalSet intervals = covered;
-        bool is_covered = false;
+        bool found = false;
 
         static_assert(ReverseLookup, "forward lookup in IntervalMap is not yet supported");
-        for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
-            if (interval.isUnknown() || it->first.isUnknown() || (it->first.overlaps(interval) && !isCovered(it->first, intervals))) {
-                intervals.insert(it->first);
-                result.push_back(it->second);
-                is_covered = isCovered(interval, intervals);
+        for (size_t idx : getCandidates(interval)) {
+            const auto& bucket = buckets[idx];
+            if (interval.isUnknown() || bucket.first.isUnknown() || !intervals.isCovered(bucket.first)) {
+                intervals.insert(bucket.first);
+                result.push_back(bucket.second);
+                found = true;
             }
         }
 
-        return std::tuple<std::vector<V>, std::vector<Interval>, bool>(std::move(result), std::move(intervals.moveVector()), is_covered);
+        bool is_covered = found && intervals.isCovered(interval);
+        return std::tuple<std::vector<V>, std::vector<Interval>, bool>(std::move(result), intervals.moveVector(), is_covered);
     }
 
     /**
@@ -196,10 +368,8 @@ public:
         std::vector<V> result;
 
         static_assert(ReverseLookup, "forward lookup in IntervalMap is not yet supported");
-        for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
-            if (interval.isUnknown() || it->first.isUnknown() || it->first.overlaps(interval)) {
-                result.push_back(it->second);
-            }
+        for (size_t idx : getCandidates(interval)) {
+            result.push_back(buckets[idx].second);
         }
         return result;
     }
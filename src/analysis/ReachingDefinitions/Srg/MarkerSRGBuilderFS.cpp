@@ -16,44 +16,75 @@ static detail::Interval concretize(detail::Interval interval) {
  * Saves the current definition of certain variable in given block
  * Used from value numbering procedures.
  */
-void MarkerSRGBuilderFS::writeVariableStrong(const DefSite& var, NodeT *assignment, BlockT *block) {
+void MarkerSRGBuilderFS::writeVariableStrong(const DefSite& var, unsigned var_id, NodeT *assignment, unsigned block) {
     // remember the last definition
-    current_def[var.target][block].add(concretize(detail::Interval{var.offset, var.len}), assignment);
+    getRegion(block).current_def.get(var_id, block).add(concretize(detail::Interval{var.offset, var.len}), assignment);
 }
 
-void MarkerSRGBuilderFS::writeVariableWeak(const DefSite& var, NodeT *assignment, BlockT *block) {
-    weak_def[var.target][block].add(concretize(detail::Interval{var.offset, var.len}), assignment);
+void MarkerSRGBuilderFS::writeVariableWeak(const DefSite& var, unsigned var_id, NodeT *assignment, unsigned block) {
+    getRegion(block).weak_def.get(var_id, block).add(concretize(detail::Interval{var.offset, var.len}), assignment);
 }
 
-std::vector<MarkerSRGBuilderFS::NodeT *> MarkerSRGBuilderFS::readVariable(const DefSite& var, BlockT *read, const Intervals& covered) {
-    assert( read );
+std::tuple<std::vector<MarkerSRGBuilderFS::NodeT *>, MarkerSRGBuilderFS::Intervals, bool>
+MarkerSRGBuilderFS::collectLastDefs(unsigned var_id, unsigned block, const detail::Interval& interval, const Intervals& covered) {
+    auto *defs = getRegion(block).last_def.find(var_id, block);
+    if (defs)
+        return defs->collect(interval, covered);
 
-    auto& block_defs = current_def[var.target];
-    auto it = block_defs.find(read);
+    return std::tuple<std::vector<NodeT *>, Intervals, bool>(std::vector<NodeT *>(), covered, false);
+}
+
+std::vector<MarkerSRGBuilderFS::NodeT *> MarkerSRGBuilderFS::readVariable(Region& R, const DefSite& var, unsigned var_id, unsigned read, const Intervals& covered) {
+    assert( read < blocks.size() );
+
+    auto *block_defs = getRegion(read).current_def.find(var_id, read);
     std::vector<NodeT *> result;
     const auto interval = concretize(detail::Interval{var.offset, var.len});
 
     // find the last definition
-    if (it != block_defs.end()) {
+    if (block_defs) {
         Intervals cov;
         bool is_covered = false;
-        std::tie(result, cov, is_covered) = it->second.collect(interval, covered);
+        std::tie(result, cov, is_covered) = block_defs->collect(interval, covered);
         if (!is_covered || interval.isUnknown()) {
-            NodeT *phi = readVariableRecursive(var, read, cov);
+            NodeT *phi = readVariableRecursive(R, var, var_id, read, cov);
             result.push_back(phi);
         }
     } else {
-        result.push_back(readVariableRecursive(var, read, covered));
+        result.push_back(readVariableRecursive(R, var, var_id, read, covered));
     }
 
     // add weak defs
-    const auto block_weak_defs = weak_def[var.target][read].collectAll(interval);
-    result.insert(result.end(), block_weak_defs.begin(), block_weak_defs.end());
+    if (auto *weak_defs = getRegion(read).weak_def.find(var_id, read)) {
+        const auto block_weak_defs = weak_defs->collectAll(interval);
+        result.insert(result.end(), block_weak_defs.begin(), block_weak_defs.end());
+    }
 
     return result;
 }
 
-void MarkerSRGBuilderFS::addPhiOperands(DefSite var, NodeT *phi, BlockT *block, const std::vector<detail::Interval>& covered) {
+void MarkerSRGBuilderFS::readPredecessor(Region& R, const DefSite& var, unsigned var_id, unsigned pred,
+                                         const detail::Interval& interval, const Intervals& covered, NodeT *phi) {
+    // the other region may be processed by another thread right now,
+    // read from it when all regions are done
+    if (!resolving && &getRegion(pred) != &R) {
+        R.pending.emplace_back(var, var_id, pred, interval, covered, phi);
+        return;
+    }
+
+    std::vector<NodeT *> assignments;
+    Intervals cov;
+    bool is_covered = false;
+    std::tie(assignments, cov, is_covered) = collectLastDefs(var_id, pred, interval, covered);
+    if (!is_covered) {
+        std::vector<NodeT *> assignments2 = readVariable(R, var, var_id, pred, cov);
+        assignments.insert(assignments.begin(), assignments2.begin(), assignments2.end());
+    }
+    for (NodeT *assignment : assignments)
+        insertSrgEdge(R, assignment, phi, var);
+}
+
+void MarkerSRGBuilderFS::addPhiOperands(Region& R, DefSite var, unsigned var_id, NodeT *phi, unsigned block, const std::vector<detail::Interval>& covered) {
 
     if (var.len == 0 || var.offset.isUnknown()) {
         var.len = Offset::UNKNOWN;
@@ -62,56 +93,154 @@ void MarkerSRGBuilderFS::addPhiOperands(DefSite var, NodeT *phi, BlockT *block,
     phi->addDef(var, true);
     phi->addUse(var);
 
-    for (BlockT *pred : block->predecessors()) {
-        std::vector<NodeT *> assignments;
-        Intervals cov;
-        bool is_covered = false;
-        std::tie(assignments,cov,is_covered) = last_def[var.target][pred].collect(detail::Interval{var.offset, var.len}, covered);
-        if (!is_covered) {
-            std::vector<NodeT *> assignments2 = readVariable(var, pred, cov);
-            assignments.insert(assignments.begin(), assignments2.begin(), assignments2.end());
-        }
-        for (auto& assignment : assignments)
-            insertSrgEdge(assignment, phi, var);
+    for (unsigned i = preds_begin[block]; i < preds_begin[block + 1]; ++i) {
+        readPredecessor(R, var, var_id, preds[i], detail::Interval{var.offset, var.len}, covered, phi);
     }
 }
 
-MarkerSRGBuilderFS::NodeT *MarkerSRGBuilderFS::readVariableRecursive(const DefSite& var, BlockT *block, const std::vector<detail::Interval>& covered) {
-    std::vector<NodeT *> result;
-    bool is_covered = false;
-
+MarkerSRGBuilderFS::NodeT *MarkerSRGBuilderFS::readVariableRecursive(Region& R, const DefSite& var, unsigned var_id, unsigned block, const std::vector<detail::Interval>& covered) {
     NodeT *val = nullptr;
-    if (block->predecessorsNum() == 1) {
-        BlockT *predBB = *(block->predecessors().begin());
-        Intervals cov;
+    if (preds_begin[block + 1] - preds_begin[block] == 1) {
+        const unsigned predBB = preds[preds_begin[block]];
 
         auto phi = std::unique_ptr<NodeT>(new NodeT(RDNodeType::PHI));
         phi->addDef(var, true);
         phi->addUse(var);
-        phi->setBasicBlock(block);
-        writeVariableStrong(var, phi.get(), block);
-
-        std::vector<NodeT *> assignments;
-        std::tie(assignments, cov, is_covered) = last_def[var.target][predBB].collect(concretize(detail::Interval{var.offset,var.len}), covered);
-        if (!is_covered) {
-            std::vector<NodeT *> assignments2 = readVariable(var, predBB, cov);
-            assignments.insert(assignments.begin(), assignments2.begin(), assignments2.end());
-        }
-        for (NodeT *node : assignments) {
-            insertSrgEdge(node, phi.get(), var);
-        }
-        val = phi.get();
-        phi_nodes.push_back(std::move(phi));
+        phi->setBasicBlock(blocks[block]);
+        writeVariableStrong(var, var_id, phi.get(), block);
+
+        readPredecessor(R, var, var_id, predBB, concretize(detail::Interval{var.offset,var.len}), covered, phi.get());
 
+        val = phi.get();
+        R.phi_nodes.push_back(std::move(phi));
     } else {
         auto phi = std::unique_ptr<NodeT>(new NodeT(RDNodeType::PHI));
 
-        phi->setBasicBlock(block);
-        writeVariableStrong(var, phi.get(), block);
-        addPhiOperands(var, phi.get(), block, covered);
+        phi->setBasicBlock(blocks[block]);
+        writeVariableStrong(var, var_id, phi.get(), block);
+
+        addPhiOperands(R, var, var_id, phi.get(), block, covered);
 
         val = phi.get();
-        phi_nodes.push_back(std::move(phi));
+        R.phi_nodes.push_back(std::move(phi));
     }
     return val;
 }
+
+void MarkerSRGBuilderFS::numberBlocks(BlockT *root) {
+    BBlockBFS<NodeT> bfs(BFS_BB_CFG | BFS_INTERPROCEDURAL);
+
+    std::unordered_map<BlockT *, unsigned> ids;
+    bfs.run(root, [&](BlockT *block, void*){
+        ids.emplace(block, blocks.size());
+        blocks.push_back(block);
+    }, nullptr);
+
+    // the value numbering runs only on the reachable blocks,
+    // but the predecessors may be unreachable, give them ids too
+    cfg_size = blocks.size();
+    preds_begin.push_back(0);
+    for (unsigned i = 0; i < blocks.size(); ++i) {
+        for (BlockT *pred : blocks[i]->predecessors()) {
+            auto it = ids.emplace(pred, blocks.size());
+            if (it.second)
+                blocks.push_back(pred);
+
+            preds.push_back(it.first->second);
+        }
+        preds_begin.push_back(preds.size());
+    }
+}
+
+void MarkerSRGBuilderFS::numberVariables() {
+    auto number = [this](NodeT *target) {
+        var_ids.emplace(target, var_ids.size());
+    };
+
+    std::unordered_set<NodeT *> defined;
+    number(UNKNOWN_MEMORY);
+    for (unsigned i = 0; i < cfg_size; ++i) {
+        for (NodeT *node : blocks[i]->getNodes()) {
+            for (const DefSite& def : node->defs) {
+                number(def.target);
+                has_unknown_defs |= def.target->isUnknown();
+                if (!def.target->isUnknown() && defined.insert(def.target).second)
+                    defined_vars.push_back(def.target);
+            }
+            for (const DefSite& use : node->getUses())
+                number(use.target);
+        }
+    }
+}
+
+bool MarkerSRGBuilderFS::isInterproceduralEdge(unsigned from, unsigned to) const {
+    // the block with a call is connected to the entry of the called
+    // function and the exit of the function is connected to the block
+    // that starts with the return from the call
+    // (see LLVMRDBuilderSemisparse::createCallToFunction)
+    NodeT *last = blocks[from]->getLastNode();
+    NodeT *first = blocks[to]->getFirstNode();
+    return (last && last->getType() == RDNodeType::CALL) ||
+           (first && first->getType() == RDNodeType::CALL_RETURN);
+}
+
+void MarkerSRGBuilderFS::splitRegions() {
+    const unsigned blocks_num = blocks.size();
+    region_of.assign(blocks_num, 0);
+
+    // the regions do not depend on the number of threads,
+    // so neither the placement of phi nodes does
+
+    // union-find over the intraprocedural edges
+    std::vector<unsigned> parent(blocks_num);
+    for (unsigned i = 0; i < blocks_num; ++i)
+        parent[i] = i;
+
+    auto find = [&parent](unsigned x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+
+    for (unsigned i = 0; i < blocks_num; ++i) {
+        for (unsigned j = preds_begin[i]; j < preds_begin[i + 1]; ++j) {
+            if (isInterproceduralEdge(preds[j], i))
+                continue;
+
+            unsigned a = find(i), b = find(preds[j]);
+            // keep the smallest id as the representative,
+            // then the regions are ordered by their first block
+            if (a < b)
+                parent[b] = a;
+            else
+                parent[a] = b;
+        }
+    }
+
+    std::vector<unsigned> region_id(blocks_num, ~0U);
+    for (unsigned i = 0; i < blocks_num; ++i) {
+        unsigned rep = find(i);
+        if (region_id[rep] == ~0U) {
+            region_id[rep] = regions.size();
+            regions.emplace_back();
+        }
+
+        region_of[i] = region_id[rep];
+        regions[region_of[i]].blocks.push_back(i);
+    }
+}
+
+void MarkerSRGBuilderFS::resolvePendingReads() {
+    resolving = true;
+    for (Region& R : regions) {
+        // no new reads are deferred now
+        for (size_t i = 0; i < R.pending.size(); ++i) {
+            const PendingRead& pr = R.pending[i];
+            readPredecessor(R, pr.var, pr.var_id, pr.pred, pr.interval, pr.covered, pr.phi);
+        }
+        R.pending.clear();
+    }
+    resolving = false;
+}
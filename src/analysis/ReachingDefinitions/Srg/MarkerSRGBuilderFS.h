@@ -3,13 +3,18 @@
 
 #include <memory>
 #include <vector>
+#include <deque>
 #include <unordered_set>
 #include <unordered_map>
 #include <map>
+#include <tuple>
+#include <cassert>
 
+#include "ADT/Parallel.h"
 #include "analysis/BFS.h"
 #include "analysis/ReachingDefinitions/Srg/SparseRDGraphBuilder.h"
 #include "analysis/ReachingDefinitions/Srg/IntervalMap.h"
+#include "analysis/ReachingDefinitions/Srg/DefTable.h"
 
 namespace dg {
 namespace analysis {
@@ -24,96 +29,236 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
     using OffsetT = uint64_t;
     using Intervals = std::vector<detail::Interval>;
 
-    // for each variable { for each block { for each offset in variable { remember definition } } }
-    using DefMapT = std::unordered_map<NodeT *, std::unordered_map<BlockT *, detail::IntervalMap<NodeT *>>>;
-
-    /* the resulting graph - stored in class for convenience, moved away on return */
-    SparseRDGraph srg;
-
-    /* phi nodes added during the process */
-    std::vector<std::unique_ptr<NodeT>> phi_nodes;
+    // for each (variable, block) { for each offset in variable { remember definition } }
+    using DefMapT = detail::DefTable<detail::IntervalMap<NodeT *>>;
+
+    struct SrgEdgeRecord {
+        NodeT *from;
+        DefSite var;
+        NodeT *to;
+
+        SrgEdgeRecord(NodeT *f, const DefSite& v, NodeT *t)
+        : from(f), var(v), to(t) {}
+    };
+
+    /* read of a variable from a predecessor that is in another region,
+     * it is done after all regions are processed */
+    struct PendingRead {
+        DefSite var;
+        unsigned var_id;
+        unsigned pred;
+        detail::Interval interval;
+        Intervals covered;
+        NodeT *phi;
+
+        PendingRead(const DefSite& var, unsigned var_id, unsigned pred,
+                    const detail::Interval& interval, const Intervals& covered,
+                    NodeT *phi)
+        : var(var), var_id(var_id), pred(pred), interval(interval),
+          covered(covered), phi(phi) {}
+    };
+
+    /* The blocks are split into regions (functions) that are processed
+     * in parallel. Every region has its own work structures, so
+     * the threads do not share anything that is modified. */
+    struct Region {
+        std::vector<unsigned> blocks;
+
+        /* work structures for strong defs */
+        DefMapT current_def;
+        DefMapT last_def;
+
+        /* work structure for weak defs */
+        DefMapT weak_def;
+
+        /* phi nodes and edges added by this region */
+        std::vector<std::unique_ptr<NodeT>> phi_nodes;
+        std::vector<SrgEdgeRecord> edges;
+        std::vector<PendingRead> pending;
+    };
+
+    /* number of threads to use */
+    unsigned threads;
+
+    // deque, so that adding regions does not copy the existing ones
+    std::deque<Region> regions;
+    std::vector<unsigned> region_of;
+
+    /* set while resolving the pending reads, then
+     * the reads may go to other regions */
+    bool resolving = false;
+
+    /* true if some node defines UNKNOWN_MEMORY */
+    bool has_unknown_defs = false;
+
+    /* dense ids of variables */
+    std::unordered_map<NodeT *, unsigned> var_ids;
+
+    /* variables (but UNKNOWN_MEMORY) that are defined by some node,
+     * a read of unknown memory may read any of them */
+    std::vector<NodeT *> defined_vars;
+
+    /* blocks by their ids, the first cfg_size blocks are reachable from the root */
+    std::vector<BlockT *> blocks;
+    unsigned cfg_size = 0;
+    /* ids of predecessors of block i are preds[preds_begin[i]] .. preds[preds_begin[i + 1] - 1] */
+    std::vector<unsigned> preds_begin;
+    std::vector<unsigned> preds;
+
+    unsigned getVarId(NodeT *target) const {
+        // all variables are numbered before the value numbering
+        auto it = var_ids.find(target);
+        assert(it != var_ids.end() && "Variable has no id");
+        return it->second;
+    }
 
-    /* work structures for strong defs */
-    DefMapT current_def;
-    DefMapT last_def;
+    Region& getRegion(unsigned block) {
+        return regions[region_of[block]];
+    }
 
-    /* work structure for weak defs */
-    DefMapT weak_def;
+    void numberBlocks(BlockT *root);
+    void numberVariables();
+    void splitRegions();
+    bool isInterproceduralEdge(unsigned from, unsigned to) const;
+    void resolvePendingReads();
 
-    void writeVariableStrong(const DefSite& var, NodeT *assignment, BlockT *block);
-    void writeVariableWeak(const DefSite& var, NodeT *assignment, BlockT *block);
-    NodeT *readVariableRecursive(const DefSite& var, BlockT *block, const Intervals& covered);
+    void writeVariableStrong(const DefSite& var, unsigned var_id, NodeT *assignment, unsigned block);
+    void writeVariableWeak(const DefSite& var, unsigned var_id, NodeT *assignment, unsigned block);
+    NodeT *readVariableRecursive(Region& R, const DefSite& var, unsigned var_id, unsigned block, const Intervals& covered);
 
-    std::vector<NodeT *> readVariable(const DefSite& var, BlockT *read) {
+    std::vector<NodeT *> readVariable(Region& R, const DefSite& var, unsigned block) {
         Intervals empty_vector;
-        return readVariable(var, read, empty_vector);
+        return readVariable(R, var, getVarId(var.target), block, empty_vector);
     }
 
-    std::vector<NodeT *> readVariable(const DefSite& var, BlockT *read, const Intervals& covered);
+    std::vector<NodeT *> readVariable(Region& R, const DefSite& var, unsigned var_id, unsigned read, const Intervals& covered);
+
+    // add the definitions of @var that reach the end of @pred as operands of @phi
+    void readPredecessor(Region& R, const DefSite& var, unsigned var_id, unsigned pred,
+                         const detail::Interval& interval, const Intervals& covered, NodeT *phi);
+
+    std::tuple<std::vector<NodeT *>, Intervals, bool>
+        collectLastDefs(unsigned var_id, unsigned block, const detail::Interval& interval, const Intervals& covered);
 
-    void addPhiOperands(DefSite var, NodeT *phi, BlockT *block, const Intervals& covered);
+    void addPhiOperands(Region& R, DefSite var, unsigned var_id, NodeT *phi, unsigned block, const Intervals& covered);
 
-    void insertSrgEdge(NodeT *from, NodeT *to, const DefSite& var) {
-        srg[from].push_back(std::make_pair(var, to));
+    void insertSrgEdge(Region& R, NodeT *from, NodeT *to, const DefSite& var) {
+        R.edges.emplace_back(from, var, to);
     }
 
-    void performLvn(BlockT *block) {
-        for (NodeT *node : block->getNodes()) {
+    void performLvn(unsigned block) {
+        for (NodeT *node : blocks[block]->getNodes()) {
 
             for (const DefSite& def : node->defs) {
+                const unsigned var_id = getVarId(def.target);
                 if (node->isOverwritten(def) && def.len != 0 && def.offset != Offset::UNKNOWN)
-                    last_def[def.target][block].add(detail::Interval{def.offset, def.len}, node);
+                    getRegion(block).last_def.get(var_id, block).add(detail::Interval{def.offset, def.len}, node);
                 else
-                    writeVariableWeak(def, node, block);
+                    writeVariableWeak(def, var_id, node, block);
             }
         }
     }
 
-    void performGvn(BlockT *block) {
+    void performGvn(Region& R, unsigned block) {
 
-        for (NodeT *node : block->getNodes()) {
+        for (NodeT *node : blocks[block]->getNodes()) {
 
+            bool reads_unknown = false;
             for (const DefSite& use : node->getUses()) {
-                std::vector<NodeT *> assignments = readVariable(use, block);
+                std::vector<NodeT *> assignments = readVariable(R, use, block);
                 // add edge from last definition to here
                 for (NodeT *assignment : assignments) {
-                    insertSrgEdge(assignment, node, use);
+                    insertSrgEdge(R, assignment, node, use);
+                }
+
+                reads_unknown |= use.target->isUnknown();
+            }
+
+            // a read of unknown memory may read any memory,
+            // so it reads all the defined variables
+            if (reads_unknown) {
+                for (NodeT *target : defined_vars) {
+                    DefSite var(target);
+                    for (NodeT *assignment : readVariable(R, var, block)) {
+                        insertSrgEdge(R, assignment, node, var);
+                    }
+                }
+            }
+
+            // UNKNOWN_MEMORY is a variable of its own, the definitions
+            // of unknown memory may define any memory used by the node,
+            // so every read consults them too
+            if (has_unknown_defs && !reads_unknown && !node->getUses().empty()) {
+                DefSite unknown(UNKNOWN_MEMORY);
+                for (NodeT *assignment : readVariable(R, unknown, block)) {
+                    insertSrgEdge(R, assignment, node, unknown);
                 }
             }
 
             for (const DefSite& def : node->defs) {
                 if (node->isOverwritten(def) && def.len != 0 && def.offset != Offset::UNKNOWN)
-                    writeVariableStrong(def, node, block);
+                    writeVariableStrong(def, getVarId(def.target), node, block);
             }
         }
     }
 
+    void processRegion(Region& R) {
+        for (unsigned BB : R.blocks) {
+            if (BB < cfg_size)
+                performLvn(BB);
+        }
+
+        for (unsigned BB : R.blocks) {
+            if (BB < cfg_size)
+                performGvn(R, BB);
+        }
+    }
+
 public:
+    /**
+     * @threads - number of threads used to build the graph,
+     *             0 means to use all hardware threads. The functions
+     *             are processed in parallel and the reads over calls
+     *             and returns are resolved afterwards, so the graph
+     *             is the same for any number of threads.
+     */
+    MarkerSRGBuilderFS(unsigned threads = 1)
+    : threads(ADT::getThreadsNum(threads)) {}
 
     std::pair<SparseRDGraph, std::vector<std::unique_ptr<NodeT>>>
         build(NodeT *root) override {
 
-        current_def.clear();
-
-        BBlockBFS<NodeT> bfs(BFS_BB_CFG | BFS_INTERPROCEDURAL);
-
-        AssignmentFinder af;
-        af.populateUnknownMemory(root);
-
-        std::vector<BlockT *> cfg;
-        BlockT *block = root->getBBlock();
-        bfs.run(block, [&](BlockT *block, void*){
-            cfg.push_back(block);
-        }, nullptr);
-
-        for (BlockT *BB : cfg) {
-            performLvn(BB);
-        }
-
-        for (BlockT *BB : cfg) {
-            performGvn(BB);
+        regions.clear();
+        region_of.clear();
+        var_ids.clear();
+        defined_vars.clear();
+        blocks.clear();
+        preds_begin.clear();
+        preds.clear();
+        has_unknown_defs = false;
+        resolving = false;
+
+        numberBlocks(root->getBBlock());
+        numberVariables();
+        splitRegions();
+
+        ADT::parallelFor(regions.size(), threads,
+                         [this](size_t i) { processRegion(regions[i]); });
+
+        resolvePendingReads();
+
+        // gather the results in the order of regions,
+        // so that the graph does not depend on the scheduling
+        SparseRDGraph srg;
+        std::vector<std::unique_ptr<NodeT>> phi_nodes;
+        for (Region& R : regions) {
+            for (const SrgEdgeRecord& e : R.edges)
+                srg[e.from].push_back(std::make_pair(e.var, e.to));
+            for (auto& phi : R.phi_nodes)
+                phi_nodes.push_back(std::move(phi));
         }
 
+        regions.clear();
         return std::make_pair<SparseRDGraph, std::vector<std::unique_ptr<NodeT>>>(std::move(srg), std::move(phi_nodes));
     }
 
@@ -3,6 +3,10 @@
 #define _DG_PHIPLACEMENT_H_
 
 #include <set>
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "BBlock.h"
 #include "analysis/ReachingDefinitions/Srg/AssignmentFinder.h"
@@ -18,52 +22,158 @@ using PhiAdditions = std::unordered_map<BBlock<RDNode> *, std::set<DefSite>>;
 /**
  * Calculates where phi-functions for variables should be placed to create SSA form
  * Prerequisites:
- * + Dominance Frontiers calculated on BBlock-s
+ * + Dominator tree calculated on BBlock-s (immediate dominators and their children)
  * + Assignment Map
  */
 class PhiPlacement
 {
 private:
     using RDBlock = BBlock<RDNode>;
+    // variable -> its definitions and uses in a block
+    using Occurrences = std::unordered_map<RDNode *, std::set<DefSite>>;
+
+    static const unsigned NOT_IN_TREE = ~static_cast<unsigned>(0);
+
+    // depth of the block in the dominator tree
+    static unsigned getLevel(RDBlock *B, std::unordered_map<RDBlock *, unsigned>& levels)
+    {
+        std::vector<RDBlock *> path;
+        unsigned level = 0;
+        while (true) {
+            auto it = levels.find(B);
+            if (it != levels.end()) {
+                level = it->second;
+                break;
+            }
+
+            path.push_back(B);
+            RDBlock *idom = B->getIDom();
+            if (!idom) {
+                // the entry blocks have no predecessors, a block that
+                // has predecessors, but no immediate dominator,
+                // is not reachable and so it is not in the tree
+                if (B->predecessorsNum() == 0) {
+                    levels[B] = level = 0;
+                    path.pop_back();
+                } else {
+                    level = NOT_IN_TREE;
+                }
+                break;
+            }
+
+            B = idom;
+        }
+
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            if (level != NOT_IN_TREE)
+                ++level;
+            levels[*it] = level;
+        }
+
+        return level;
+    }
+
+    /**
+     * Computes the iterated dominance frontier of the @def_blocks.
+     * The algorithm is due:
+     *
+     * V. C. Sreedhar and G. R. Gao. 1995. A linear time algorithm for placing
+     * phi-nodes. In Proceedings of the 22nd ACM SIGPLAN-SIGACT symposium on
+     * Principles of programming languages (POPL '95), 62-73.
+     *
+     * The blocks are processed from the deepest ones in the dominator tree.
+     * From every block we walk its dominator subtree and the targets of join
+     * edges (edges that are not dominator tree edges) that are not deeper
+     * than the block are in the IDF.
+     */
+    static std::vector<RDBlock *> computeIDF(const std::set<RDBlock *>& def_blocks,
+                                             std::unordered_map<RDBlock *, unsigned>& levels)
+    {
+        std::vector<RDBlock *> idf;
+        std::priority_queue<std::pair<unsigned, RDBlock *>> queue;
+        std::unordered_set<RDBlock *> in_idf;
+        std::unordered_set<RDBlock *> visited;
+        std::vector<RDBlock *> worklist;
+
+        for (RDBlock *B : def_blocks) {
+            unsigned level = getLevel(B, levels);
+            if (level != NOT_IN_TREE)
+                queue.push(std::make_pair(level, B));
+        }
+
+        while (!queue.empty()) {
+            const unsigned root_level = queue.top().first;
+            RDBlock *root = queue.top().second;
+            queue.pop();
+
+            visited.insert(root);
+            worklist.push_back(root);
+
+            while (!worklist.empty()) {
+                RDBlock *X = worklist.back();
+                worklist.pop_back();
+
+                for (const auto& edge : X->successors()) {
+                    RDBlock *Y = edge.target;
+                    if (Y->getIDom() == X)
+                        continue;
+
+                    unsigned level = getLevel(Y, levels);
+                    if (level > root_level || !in_idf.insert(Y).second)
+                        continue;
+
+                    idf.push_back(Y);
+                    // Y has a phi node now, so it is a definition too
+                    if (def_blocks.count(Y) == 0)
+                        queue.push(std::make_pair(level, Y));
+                }
+
+                for (RDBlock *Z : X->getDominators()) {
+                    if (visited.insert(Z).second)
+                        worklist.push_back(Z);
+                }
+            }
+        }
+
+        return idf;
+    }
+
+    static const Occurrences& getOccurrences(RDBlock *B,
+                                             std::unordered_map<RDBlock *, Occurrences>& occurrences)
+    {
+        auto it = occurrences.find(B);
+        if (it != occurrences.end())
+            return it->second;
+
+        Occurrences& occ = occurrences[B];
+        for (RDNode *N : B->getNodes()) {
+            for (const DefSite& cds : N->getDefines())
+                occ[cds.target].insert(cds);
+            for (const DefSite& cds : N->getUses())
+                occ[cds.target].insert(cds);
+        }
+
+        return occ;
+    }
 
 public:
     PhiAdditions calculate(AssignmentMap&& am) const
     {
         PhiAdditions result;
+        std::unordered_map<RDBlock *, unsigned> levels;
+        // the occurrences of variables are gathered only once per block
+        std::unordered_map<RDBlock *, Occurrences> occurrences;
+
         for (auto& def : am) {
-            // DomFronPlus
-            std::set<RDBlock *> dfp;
-            std::vector<RDNode *> w = std::move(def.second);
-            std::set<RDNode *> work(w.begin(), w.end());
-
-            while (!w.empty()) {
-                RDNode *n = w.back();
-                w.pop_back();
-                RDBlock *X = n->getBBlock();
-
-                for (RDBlock* Y : X->getDomFrontiers()) {
-                    if (dfp.find(Y) == dfp.end()) {
-
-                        for (RDNode *N : Y->getNodes()) {
-                            for (const DefSite& cds : N->getDefines()) {
-                                if (cds.target == def.first) {
-                                    result[Y].insert(cds);
-                                }
-                            }
-                            for (const DefSite& cds : N->getUses()) {
-                                if (cds.target == def.first) {
-                                    result[Y].insert(cds);
-                                }
-                            }
-                        }
-
-                        dfp.insert(Y);
-                        if (work.find(Y->getFirstNode()) == work.end()) {
-                            work.insert(Y->getFirstNode());
-                            w.push_back(Y->getFirstNode());
-                        }
-                    }
-                }
+            std::set<RDBlock *> def_blocks;
+            for (RDNode *n : def.second)
+                def_blocks.insert(n->getBBlock());
+
+            for (RDBlock *Y : computeIDF(def_blocks, levels)) {
+                const Occurrences& occ = getOccurrences(Y, occurrences);
+                auto it = occ.find(def.first);
+                if (it != occ.end())
+                    result[Y].insert(it->second.begin(), it->second.end());
             }
         }
         return result;
@@ -17,15 +17,20 @@ using dg::ADT::QueueFIFO;
 namespace dg {
 namespace analysis {
 
+template <typename NodeT>
+class Slicer;
+
 // this class will go through the nodes
 // and will mark the ones that should be in the slice
 template <typename NodeT>
 class WalkAndMark : public NodesWalk<NodeT, QueueFIFO<NodeT *>>
 {
 public:
-    WalkAndMark()
+    // the slicer (if any) is told when we enter a dependence graph
+    WalkAndMark(Slicer<NodeT> *slicer = nullptr)
         : NodesWalk<NodeT, QueueFIFO<NodeT *>>(NODES_WALK_REV_CD |
-                                               NODES_WALK_REV_DD) {}
+                                               NODES_WALK_REV_DD),
+          slicer(slicer) {}
 
     void mark(NodeT *start, uint32_t slice_id)
     {
@@ -43,6 +48,8 @@ private:
         WalkAndMark *analysis;
     };
 
+    Slicer<NodeT> *slicer;
+
     static void markSlice(NodeT *n, WalkData *data)
     {
         uint32_t slice_id = data->slice_id;
@@ -60,6 +67,12 @@ private:
         // a dependence graph, we need to keep the dependence graph
         DependenceGraph<NodeT> *dg = n->getDG();
         if (dg) {
+            // we are in this graph for the first time, the slicer
+            // may need to compute the rest of its edges. We are called
+            // before the edges of the node are processed, so it is not late
+            if (dg->getSlice() != slice_id && data->analysis->slicer)
+                data->analysis->slicer->enterGraph(dg);
+
             dg->setSlice(slice_id);
             // and keep also all call-sites of this func (they are
             // control dependent on the entry node)
@@ -108,6 +121,9 @@ class Slicer : Analysis<NodeT>
             }
         }
 
+        // drop the removed nodes from the map of nodes
+        dg->getNodes()->compact();
+
         // FIXME if graph own global nodes, slice the global nodes
     }
 
@@ -128,7 +144,7 @@ public:
         if (sl_id == 0)
             sl_id = ++slice_id;
 
-        WalkAndMark<NodeT> wm;
+        WalkAndMark<NodeT> wm(this);
         wm.mark(start, sl_id);
 
         return sl_id;
@@ -144,6 +160,15 @@ public:
         return sl_id;
     }
 
+    // called when marking reaches a node of @dg for the first
+    // time in the slice, before the edges of the node are followed.
+    // This virtual method allows to compute the edges of the graph
+    // only when they are needed
+    virtual void enterGraph(DependenceGraph<NodeT> *dg)
+    {
+        (void) dg;
+    }
+
     // remove node from the graph
     // This virtual method allows to taky an action
     // when node is being removed from the graph. It can also
@@ -159,8 +159,8 @@ public:
         if (!ensureFile(new_file))
             return false;
 
-        const std::map<llvm::Value *,
-                       LLVMDependenceGraph *>& CF = getConstructedFunctions();
+        const std::map<llvm::Value *, LLVMDependenceGraph *>& CF
+            = static_cast<LLVMDependenceGraph *>(dg)->getConstructedFunctions();
 
         start();
 
@@ -223,8 +223,8 @@ public:
         if (!ensureFile(new_file))
             return false;
 
-        const std::map<llvm::Value *,
-                       LLVMDependenceGraph *>& CF = getConstructedFunctions();
+        const std::map<llvm::Value *, LLVMDependenceGraph *>& CF
+            = static_cast<LLVMDependenceGraph *>(dg)->getConstructedFunctions();
 
         start();
 
@@ -44,6 +44,7 @@ private:
     AnnotationOptsT opts;
     LLVMPointerAnalysis *PTA;
     LLVMReachingDefinitions *RD;
+    const LLVMDependenceGraph *dg;
     std::string module_comment{};
 
     void printValue(const llvm::Value *val,
@@ -130,7 +131,8 @@ private:
             if (!rd) {
                 os << "  ; RD: no mapping\n";
             } else {
-                auto& defs = rd->getReachingDefinitions();
+                analysis::rd::RDMap defs;
+                rd->getReachingDefinitions(defs);
                 for (auto& it : defs) {
                     for (auto& nd : it.second) {
                         printDefSite(it.first, os, "RD: ");
@@ -229,10 +231,11 @@ private:
     }
 
 public:
-    LLVMDGAssemblyAnnotationWriter(AnnotationOptsT o = ANNOTATE_SLICE,
+    LLVMDGAssemblyAnnotationWriter(const LLVMDependenceGraph *dg,
+                                   AnnotationOptsT o = ANNOTATE_SLICE,
                                    LLVMPointerAnalysis *pta = nullptr,
                                    LLVMReachingDefinitions *rd = nullptr)
-        : opts(o), PTA(pta), RD(rd)
+        : opts(o), PTA(pta), RD(rd), dg(dg)
     {
         assert(!(opts & ANNOTATE_PTR) || PTA);
         assert(!(opts & ANNOTATE_RD) || RD);
@@ -265,7 +268,7 @@ public:
             return;
 
         LLVMNode *node = nullptr;
-        for (auto& it : getConstructedFunctions()) {
+        for (auto& it : dg->getConstructedFunctions()) {
             LLVMDependenceGraph *sub = it.second;
             node = sub->getNode(const_cast<llvm::Instruction *>(I));
             if (node)
@@ -284,7 +287,7 @@ public:
         if (opts == 0)
             return;
 
-        for (auto& it : getConstructedFunctions()) {
+        for (auto& it : dg->getConstructedFunctions()) {
             LLVMDependenceGraph *sub = it.second;
             auto& cb = sub->getBlocks();
             auto I = cb.find(const_cast<llvm::BasicBlock *>(B));
@@ -47,6 +47,7 @@
 #include "llvm/analysis/PointsTo/PointsTo.h"
 #include "llvm/analysis/ControlExpression.h"
 #include "llvm-utils.h"
+#include "ADT/Parallel.h"
 
 using llvm::errs;
 using std::make_pair;
@@ -57,17 +58,16 @@ namespace dg {
 //  -- LLVMDependenceGraph
 /// ------------------------------------------------------------------
 
-// map of all constructed functions
-std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
-
-const std::map<llvm::Value *,
-               LLVMDependenceGraph *>& getConstructedFunctions()
-{
-    return constructedFunctions;
-}
-
 LLVMDependenceGraph::~LLVMDependenceGraph()
 {
+    // do not leave a dangling graph in the context
+    // that may be still used by other graphs
+    if (context && getEntry()) {
+        auto it = context->constructedFunctions.find(getEntry()->getKey());
+        if (it != context->constructedFunctions.end() && it->second == this)
+            context->constructedFunctions.erase(it);
+    }
+
     // delete nodes
     for (auto I = begin(), E = end(); I != E; ++I) {
         LLVMNode *node = I->second;
@@ -140,6 +140,8 @@ bool LLVMDependenceGraph::build(llvm::Module *m, llvm::Function *entry)
     }
 
     module = m;
+    if (!context)
+        context = std::make_shared<DGContext>();
 
     // add global nodes. These will be shared across subgraphs
     addGlobals(m, this);
@@ -177,8 +179,8 @@ bool LLVMDependenceGraph::addFormalGlobal(llvm::Value *val)
     if (params->find(val))
         return false;
 
-    LLVMNode *fpin = new LLVMNode(val);
-    LLVMNode *fpout = new LLVMNode(val);
+    LLVMNode *fpin = new (getNodesPool()) LLVMNode(val);
+    LLVMNode *fpout = new (getNodesPool()) LLVMNode(val);
     fpin->setDG(this);
     fpout->setDG(this);
     params->addGlobal(val, fpin, fpout);
@@ -237,18 +239,11 @@ LLVMDependenceGraph::buildSubgraph(LLVMNode *node, llvm::Function *callFunc)
 
     // if we don't have this subgraph constructed, construct it
     // else just add call edge
-    LLVMDependenceGraph *&subgraph = constructedFunctions[callFunc];
+    auto it = context->constructedFunctions.find(callFunc);
+    LLVMDependenceGraph *subgraph
+        = it == context->constructedFunctions.end() ? nullptr : it->second;
     if (!subgraph) {
-        // since we have reference the the pointer in
-        // constructedFunctions, we can assing to it
-        subgraph = new LLVMDependenceGraph();
-        // set global nodes to this one, so that
-        // we'll share them
-        subgraph->setGlobalNodes(getGlobalNodes());
-        subgraph->module = module;
-        subgraph->PTA = PTA;
-        // make subgraphs gather the call-sites too
-        subgraph->gatherCallsites(gather_callsites, gatheredCallsites);
+        subgraph = createSubgraph(callFunc);
 
         // make the real work
 #ifndef NDEBUG
@@ -309,8 +304,8 @@ bool LLVMDependenceGraph::addFormalParameter(llvm::Value *val)
     if (params->find(val))
         return false;
 
-    LLVMNode *fpin = new LLVMNode(val);
-    LLVMNode *fpout = new LLVMNode(val);
+    LLVMNode *fpin = new (getNodesPool()) LLVMNode(val);
+    LLVMNode *fpout = new (getNodesPool()) LLVMNode(val);
     fpin->setDG(this);
     fpout->setDG(this);
     params->add(val, fpin, fpout);
@@ -336,52 +331,85 @@ static bool isMemAllocationFunc(const llvm::Function *func)
     return false;
 }
 
-void LLVMDependenceGraph::handleInstruction(llvm::Value *val,
-                                            LLVMNode *node)
+// get the defined functions that the call may call,
+// use the points-to information for calls via pointers
+static std::vector<llvm::Function *>
+getCalledFunctions(LLVMPointerAnalysis *PTA, llvm::CallInst *CInst,
+                   bool report = true)
 {
     using namespace llvm;
 
-    if (CallInst *CInst = dyn_cast<CallInst>(val)) {
-        Value *strippedValue = CInst->getCalledValue()->stripPointerCasts();
-        Function *func = dyn_cast<Function>(strippedValue);
-        // if func is nullptr, then this is indirect call
-        // via function pointer. If we have the points-to information,
-        // create the subgraph
-        if (!func && !CInst->isInlineAsm() && PTA) {
-            using namespace analysis::pta;
-            PSNode *op = PTA->getNode(strippedValue);
-            if (op) {
-                for (const Pointer& ptr : op->pointsTo) {
-                    if (!ptr.isValid() || ptr.isInvalidated())
-                        continue;
+    std::vector<Function *> ret;
+    Value *strippedValue = CInst->getCalledValue()->stripPointerCasts();
+    Function *func = dyn_cast<Function>(strippedValue);
+    if (func) {
+        if (is_func_defined(func))
+            ret.push_back(func);
+        return ret;
+    }
 
-                    // vararg may introduce imprecision here, so we
-                    // must check that it is really pointer to a function
-                    if (!isa<Function>(ptr.target->getUserData<Value>()))
-                        continue;
+    // if func is nullptr, then this is indirect call
+    // via function pointer. If we have the points-to information,
+    // create the subgraph
+    if (CInst->isInlineAsm() || !PTA)
+        return ret;
+
+    using namespace analysis::pta;
+    PSNode *op = PTA->getNode(strippedValue);
+    if (!op) {
+        if (report)
+            llvmutils::printerr("Had no PTA node", strippedValue);
+        return ret;
+    }
 
-                    Function *F = ptr.target->getUserData<Function>();
-                    if (F->size() == 0 || !llvmutils::callIsCompatible(F, CInst))
-                        // incompatible prototypes or the function
-                        // is only declaration
-                        continue;
+    for (const Pointer& ptr : op->pointsTo) {
+        if (!ptr.isValid() || ptr.isInvalidated())
+            continue;
 
-                    LLVMDependenceGraph *subg = buildSubgraph(node, F);
-                    node->addSubgraph(subg);
-                }
-            } else
-                llvmutils::printerr("Had no PTA node", strippedValue);
-        }
+        // vararg may introduce imprecision here, so we
+        // must check that it is really pointer to a function
+        if (!isa<Function>(ptr.target->getUserData<Value>()))
+            continue;
 
-        if (func && gather_callsites &&
-            func->getName().equals(gather_callsites)) {
-            gatheredCallsites->insert(node);
-        }
+        Function *F = ptr.target->getUserData<Function>();
+        if (F->size() == 0 || !llvmutils::callIsCompatible(F, CInst))
+            // incompatible prototypes or the function
+            // is only declaration
+            continue;
 
-        if (is_func_defined(func)) {
-            LLVMDependenceGraph *subg = buildSubgraph(node, func);
-            node->addSubgraph(subg);
-        }
+        ret.push_back(F);
+    }
+
+    return ret;
+}
+
+void LLVMDependenceGraph::handleCall(LLVMNode *node)
+{
+    using namespace llvm;
+
+    CallInst *CInst = cast<CallInst>(node->getValue());
+    Function *func
+        = dyn_cast<Function>(CInst->getCalledValue()->stripPointerCasts());
+    if (func && gather_callsites &&
+        func->getName().equals(gather_callsites)) {
+        gatheredCallsites->insert(node);
+    }
+
+    for (Function *F : getCalledFunctions(PTA, CInst)) {
+        LLVMDependenceGraph *subg = buildSubgraph(node, F);
+        node->addSubgraph(subg);
+    }
+}
+
+void LLVMDependenceGraph::handleInstruction(llvm::Value *val,
+                                            LLVMNode *node)
+{
+    using namespace llvm;
+
+    if (CallInst *CInst = dyn_cast<CallInst>(val)) {
+        // the graphs built in parallel are linked later
+        if (!defer_calls)
+            handleCall(node);
 
         // if we allocate a memory in a function, we can pass
         // it to other functions, so it is like global.
@@ -411,11 +439,37 @@ void LLVMDependenceGraph::handleInstruction(llvm::Value *val,
     }
 }
 
+static LLVMBBlock *createReturnExitBB(LLVMDependenceGraph *graph,
+                                      llvm::LLVMContext& ctx)
+{
+    using namespace llvm;
+
+    // we need new llvm value, so that the nodes won't collide
+    ReturnInst *phonyRet = ReturnInst::Create(ctx);
+    if (!phonyRet) {
+        errs() << "ERR: Failed creating phony return value "
+               << "for exit node\n";
+        // XXX later we could return somehow more mercifully
+        abort();
+    }
+
+    LLVMNode *ext = new (graph->getNodesPool()) LLVMNode(phonyRet,
+                                        true /* node owns the value -
+                                                it will delete it */);
+    graph->setExit(ext);
+
+    LLVMBBlock *retBB = new (graph->getBlocksPool()) LLVMBBlock(ext);
+    retBB->deleteNodesOnDestruction();
+    graph->setExitBB(retBB);
+
+    return retBB;
+}
+
 LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
 {
     using namespace llvm;
 
-    LLVMBBlock *BB = new LLVMBBlock();
+    LLVMBBlock *BB = new (getBlocksPool()) LLVMBBlock();
     LLVMNode *node = nullptr;
 
     BB->setKey(&llvmBB);
@@ -423,7 +477,7 @@ LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
     // iterate over the instruction and create node for every single one of them
     for (Instruction& Inst : llvmBB) {
         Value *val = &Inst;
-        node = new LLVMNode(val);
+        node = new (getNodesPool()) LLVMNode(val);
 
         // add new node to this dependence graph
         addNode(node);
@@ -452,26 +506,11 @@ LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
         // on dep. graph that is not for whole llvm
         LLVMNode *ext = getExit();
         if (!ext) {
-            // we need new llvm value, so that the nodes won't collide
-            ReturnInst *phonyRet
-                = ReturnInst::Create(termval->getContext());
-            if (!phonyRet) {
-                errs() << "ERR: Failed creating phony return value "
-                       << "for exit node\n";
-                // XXX later we could return somehow more mercifully
-                abort();
-            }
-
-            ext = new LLVMNode(phonyRet, true /* node owns the value -
-                                                 it will delete it */);
-            setExit(ext);
-
-            LLVMBBlock *retBB = new LLVMBBlock(ext);
-            retBB->deleteNodesOnDestruction();
-            setExitBB(retBB);
             assert(!unifiedExitBB
                    && "We should not have it assinged yet (or again) here");
-            unifiedExitBB = std::unique_ptr<LLVMBBlock>(retBB);
+            unifiedExitBB = std::unique_ptr<LLVMBBlock>(
+                    createReturnExitBB(this, termval->getContext()));
+            ext = getExit();
         }
 
         // add control dependence from this (return) node to EXIT node
@@ -493,10 +532,11 @@ static LLVMBBlock *createSingleExitBB(LLVMDependenceGraph *graph)
 {
     llvm::UnreachableInst *ui
         = new llvm::UnreachableInst(graph->getModule()->getContext());
-    LLVMNode *exit = new LLVMNode(ui, true);
-    graph->addNode(exit);
+    LLVMNode *exit = new (graph->getNodesPool()) LLVMNode(ui, true);
+    // the node is added to the graph by buildBody(),
+    // after the nodes of the function
     graph->setExit(exit);
-    LLVMBBlock *exitBB = new LLVMBBlock(exit);
+    LLVMBBlock *exitBB = new (graph->getBlocksPool()) LLVMBBlock(exit);
     graph->setExitBB(exitBB);
 
     // XXX should we add predecessors? If the function does not
@@ -559,15 +599,25 @@ addControlDepsToPHIs(LLVMDependenceGraph *graph)
 
 bool LLVMDependenceGraph::build(llvm::Function *func)
 {
-    using namespace llvm;
-
     assert(func && "Passed no func");
 
     // do we have anything to process?
     if (func->size() == 0)
         return false;
 
-    constructedFunctions.insert(make_pair(func, this));
+    buildEntry(func);
+    buildBody(func);
+
+    return true;
+}
+
+void LLVMDependenceGraph::buildEntry(llvm::Function *func)
+{
+    // the graph is built without a module
+    if (!context)
+        context = std::make_shared<DGContext>();
+
+    context->constructedFunctions.insert(make_pair(func, this));
 
     // create entry node
     LLVMNode *entry = new LLVMNode(func);
@@ -578,6 +628,27 @@ bool LLVMDependenceGraph::build(llvm::Function *func)
 
     // add formal parameters to this graph
     addFormalParameters();
+}
+
+void LLVMDependenceGraph::buildExit(llvm::Function *func)
+{
+    using namespace llvm;
+
+    assert(!unifiedExitBB && "Already have the exit BB");
+    for (BasicBlock& B : *func) {
+        if (!B.empty() && isa<ReturnInst>(B.back())) {
+            unifiedExitBB = std::unique_ptr<LLVMBBlock>(
+                    createReturnExitBB(this, func->getContext()));
+            return;
+        }
+    }
+
+    unifiedExitBB = std::unique_ptr<LLVMBBlock>(createSingleExitBB(this));
+}
+
+void LLVMDependenceGraph::buildBody(llvm::Function *func)
+{
+    using namespace llvm;
 
     // iterate over basic blocks
     BBlocksMapT& blocks = getBlocks();
@@ -631,10 +702,110 @@ bool LLVMDependenceGraph::build(llvm::Function *func)
     assert(getEntryBB() && "Missing entry BB");
     assert(getExitBB() && "Missing exit BB");
 
+    // the artificial exit of a function without return is a node
+    // of the graph. It goes after the other nodes even when it was
+    // created ahead by buildExit(), so that the graph is the same
+    if (isa<UnreachableInst>(getExit()->getValue()))
+        addNode(getExit());
+
     addControlDepsToPHIs(this);
 
     // add CFG edge from entry point to the first instruction
-    entry->addControlDependence(getEntryBB()->getFirstNode());
+    getEntry()->addControlDependence(getEntryBB()->getFirstNode());
+}
+
+LLVMDependenceGraph *LLVMDependenceGraph::createSubgraph(llvm::Function *func)
+{
+    LLVMDependenceGraph *subgraph = new LLVMDependenceGraph();
+    // set global nodes and the context to this one,
+    // so that we'll share them
+    subgraph->setGlobalNodes(getGlobalNodes());
+    subgraph->context = context;
+    subgraph->module = module;
+    subgraph->PTA = PTA;
+    // make subgraphs gather the call-sites too
+    subgraph->gatherCallsites(gather_callsites, gatheredCallsites);
+
+    context->constructedFunctions[func] = subgraph;
+    return subgraph;
+}
+
+bool LLVMDependenceGraph::buildParallel(llvm::Module *m,
+                                        LLVMPointerAnalysis *pts,
+                                        unsigned threads,
+                                        llvm::Function *entry)
+{
+    using namespace llvm;
+
+    if (!entry)
+        entry = m->getFunction("main");
+
+    if (!entry) {
+        errs() << "No entry function found/given\n";
+        return false;
+    }
+
+    module = m;
+    PTA = pts;
+    context = std::make_shared<DGContext>();
+    addGlobals(m, this);
+
+    // nothing to build, like in build()
+    if (entry->size() == 0)
+        return true;
+
+    // find the functions reachable from the entry and create their
+    // graphs with the entry nodes, formal parameters and exit nodes.
+    // These touch the shared global nodes and create llvm values
+    // (that is not thread-safe), so it is done serially
+    std::vector<std::pair<Function *, LLVMDependenceGraph *>> graphs;
+    buildEntry(entry);
+    buildExit(entry);
+    graphs.emplace_back(entry, this);
+
+    for (size_t i = 0; i < graphs.size(); ++i) {
+        for (BasicBlock& B : *graphs[i].first) {
+            for (Instruction& I : B) {
+                CallInst *CInst = dyn_cast<CallInst>(&I);
+                if (!CInst)
+                    continue;
+
+                for (Function *F : getCalledFunctions(PTA, CInst, false)) {
+                    if (getConstructedFunctions().count(F) > 0)
+                        continue;
+
+                    LLVMDependenceGraph *subgraph = createSubgraph(F);
+                    subgraph->buildEntry(F);
+                    subgraph->buildExit(F);
+                    // the call-sites take the references
+                    // in the linking below
+                    subgraph->unref(false /* deleteOnZero */);
+                    graphs.emplace_back(F, subgraph);
+                }
+            }
+        }
+    }
+
+    // build the nodes, blocks and CFG of every function on its own,
+    // the nodes and blocks are allocated in the pools of the graphs
+    ADT::parallelFor(graphs.size(), ADT::getThreadsNum(threads),
+                     [&graphs](size_t i) {
+                         graphs[i].second->defer_calls = true;
+                         graphs[i].second->buildBody(graphs[i].first);
+                         graphs[i].second->defer_calls = false;
+                     });
+
+    // link the call-sites to the graphs of called functions,
+    // in the order of the functions and instructions, so that
+    // the result does not depend on the threads
+    for (auto& it : graphs) {
+        for (BasicBlock& B : *it.first) {
+            for (Instruction& I : B) {
+                if (isa<CallInst>(&I))
+                    it.second->handleCall(it.second->getNode(&I));
+            }
+        }
+    }
 
     return true;
 }
@@ -670,8 +841,8 @@ void LLVMDependenceGraph::addFormalParameters()
     for (auto I = func->arg_begin(), E = func->arg_end(); I != E; ++I) {
         Value *val = (&*I);
 
-        in = new LLVMNode(val);
-        out = new LLVMNode(val);
+        in = new (getNodesPool()) LLVMNode(val);
+        out = new (getNodesPool()) LLVMNode(val);
         in->setDG(this);
         out->setDG(this);
         params->add(val, in, out);
@@ -684,8 +855,8 @@ void LLVMDependenceGraph::addFormalParameters()
     if (func->isVarArg()) {
         Value *val = ConstantPointerNull::get(func->getType());
         val->setName("vararg");
-        in = new LLVMNode(val, true);
-        out = new LLVMNode(val, true);
+        in = new (getNodesPool()) LLVMNode(val, true);
+        out = new (getNodesPool()) LLVMNode(val, true);
         in->setDG(this);
         out->setDG(this);
 
@@ -791,7 +962,7 @@ bool LLVMDependenceGraph::getCallSites(const char *name, std::set<LLVMNode *> *c
 bool LLVMDependenceGraph::getCallSites(const char *names[],
                                        std::set<LLVMNode *> *callsites)
 {
-    for (auto& F : constructedFunctions) {
+    for (auto& F : getConstructedFunctions()) {
         for (auto& I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -809,7 +980,7 @@ bool LLVMDependenceGraph::getCallSites(const char *names[],
 bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
                                        std::set<LLVMNode *> *callsites)
 {
-    for (const auto& F : constructedFunctions) {
+    for (const auto& F : getConstructedFunctions()) {
         for (const auto& I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -824,38 +995,87 @@ bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
     return callsites->size() != 0;
 }
 
+void LLVMDependenceGraph::freeze()
+{
+    if (isFrozen())
+        return;
+
+    // the parameters and global nodes are connected
+    // to the nodes of the functions, so we get them too
+    std::vector<LLVMNode *> seeds;
+    for (const auto& F : getConstructedFunctions()) {
+        for (const auto& it : *F.second)
+            seeds.push_back(it.second);
+    }
+
+    auto frozen = std::make_shared<FrozenEdges<LLVMNode>>();
+    frozen->build(seeds.begin(), seeds.end());
+
+    setFrozenEdges(frozen);
+    for (const auto& F : getConstructedFunctions())
+        F.second->setFrozenEdges(frozen);
+}
+
+void LLVMDependenceGraph::computeControlDependencies(CD_ALG alg_type,
+                                                     unsigned threads)
+{
+    // the post-dominators and the control dependencies of a function
+    // are edges between its own blocks, so the functions can be
+    // processed in parallel without any locking
+    std::vector<LLVMDependenceGraph *> graphs;
+    for (const auto& F : getConstructedFunctions())
+        graphs.push_back(F.second);
+
+    ADT::parallelFor(graphs.size(), ADT::getThreadsNum(threads),
+                     [&graphs, alg_type](size_t i) {
+        graphs[i]->computeFunctionControlDependencies(alg_type);
+    });
+}
+
+void LLVMDependenceGraph::computeFunctionControlDependencies(CD_ALG alg_type)
+{
+    if (cd_computed)
+        return;
+
+    cd_computed = true;
+    if (alg_type == CD_ALG::CLASSIC) {
+        computePostDominators(true);
+        //makeSelfLoopsControlDependent();
+    } else if (alg_type == CD_ALG::CONTROL_EXPRESSION) {
+        computeControlExpression(true);
+    } else
+        abort();
+}
+
 void LLVMDependenceGraph::computeControlExpression(bool addCDs)
 {
     LLVMCFABuilder builder;
-
-    for (auto& F : getConstructedFunctions()) {
-        llvm::Function *func = llvm::cast<llvm::Function>(F.first);
-        LLVMCFA cfa = builder.build(*func);
-
-        CE = cfa.compute();
-
-        if (addCDs) {
-            // compute the control scope
-            CE.computeSets();
-            auto& our_blocks = F.second->getBlocks();
-
-            for (llvm::BasicBlock& B : *func) {
-                LLVMBBlock *B1 = our_blocks[&B];
-
-                // if this block is a predicate block,
-                // we compute the control deps for it
-                // XXX: for now we compute the control
-                // scope, which is enough for slicing,
-                // but may add some extra (transitive)
-                // edges
-                if (B.getTerminator()->getNumSuccessors() > 1) {
-                    auto CS = CE.getControlScope(&B);
-                    for (auto cs : CS) {
-                        assert(cs->isa(CENodeType::LABEL));
-                        auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
-                        LLVMBBlock *B2 = our_blocks[lab->getLabel()];
-                        B1->addControlDependence(B2);
-                    }
+    llvm::Function *func = llvm::cast<llvm::Function>(getEntry()->getKey());
+    LLVMCFA cfa = builder.build(*func);
+
+    ControlExpression CE = cfa.compute();
+
+    if (addCDs) {
+        // compute the control scope
+        CE.computeSets();
+        auto& our_blocks = getBlocks();
+
+        for (llvm::BasicBlock& B : *func) {
+            LLVMBBlock *B1 = our_blocks[&B];
+
+            // if this block is a predicate block,
+            // we compute the control deps for it
+            // XXX: for now we compute the control
+            // scope, which is enough for slicing,
+            // but may add some extra (transitive)
+            // edges
+            if (B.getTerminator()->getNumSuccessors() > 1) {
+                auto CS = CE.getControlScope(&B);
+                for (auto cs : CS) {
+                    assert(cs->isa(CENodeType::LABEL));
+                    auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
+                    LLVMBBlock *B2 = our_blocks[lab->getLabel()];
+                    B1->addControlDependence(B2);
                 }
             }
         }
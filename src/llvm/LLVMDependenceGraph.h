@@ -13,6 +13,7 @@
 #endif
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 
 // forward declaration of llvm classes
@@ -40,6 +41,20 @@ enum class CD_ALG {
 class LLVMPointerAnalysis;
 
 using LLVMBBlock = dg::BBlock<LLVMNode>;
+class LLVMDependenceGraph;
+
+/// ------------------------------------------------------------------
+//  -- DGContext
+//     State shared by the graphs of one module. The graph built
+//     from the module creates it and the graphs of called functions
+//     share it, so graphs of different modules can be built and
+//     sliced independently (e.g. each in its own thread).
+/// ------------------------------------------------------------------
+struct DGContext
+{
+    // map of all constructed functions
+    std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
+};
 
 /// ------------------------------------------------------------------
 //  -- LLVMDependenceGraph
@@ -48,6 +63,8 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode>
 {
     // our artificial unified exit block
     std::unique_ptr<LLVMBBlock> unifiedExitBB;
+    // shared with the graphs of the called functions
+    std::shared_ptr<DGContext> context;
 public:
     LLVMDependenceGraph()
         : gather_callsites(nullptr), module(nullptr), PTA(nullptr) {}
@@ -66,11 +83,26 @@ public:
     // build subgraphs of called functions
     bool build(llvm::Function *func);
 
+    // the same as build(m, pts, entry), but the graphs of the functions
+    // reachable from the entry are built in parallel by @threads
+    // threads (0 means all the cores) and then linked together
+    bool buildParallel(llvm::Module *m, LLVMPointerAnalysis *pts,
+                       unsigned threads, llvm::Function *entry = nullptr);
+
     bool addFormalParameter(llvm::Value *val);
     bool addFormalGlobal(llvm::Value *val);
 
     llvm::Module *getModule() const { return module; }
 
+    // the graphs of all functions constructed for the module
+    // (including this one)
+    const std::map<llvm::Value *, LLVMDependenceGraph *>&
+    getConstructedFunctions() const
+    {
+        assert(context && "The graph was not built");
+        return context->constructedFunctions;
+    }
+
     // if we want to slice according some call-site(s),
     // we can gather the relevant call-sites while building
     // graph and do not need to recursively find in the graph
@@ -104,19 +136,23 @@ public:
 
     void makeSelfLoopsControlDependent();
 
-    void computeControlDependencies(CD_ALG alg_type)
-    {
-        if (alg_type == CD_ALG::CLASSIC) {
-            computePostDominators(true);
-            //makeSelfLoopsControlDependent();
-        } else if (alg_type == CD_ALG::CONTROL_EXPRESSION) {
-            computeControlExpression(true);
-        } else
-            abort();
-    }
+    // compute the control dependencies of all constructed functions,
+    // the functions are processed by @threads threads (0 = all cores)
+    void computeControlDependencies(CD_ALG alg_type, unsigned threads = 1);
+
+    // compute the control dependencies only of this function,
+    // if they were not computed yet. This allows to compute them
+    // lazily only for the functions that are reached by slicing
+    void computeFunctionControlDependencies(CD_ALG alg_type);
+    bool hasControlDependencies() const { return cd_computed; }
 
     bool verify() const;
 
+    // pack the dependence edges of all constructed functions into one
+    // array (see FrozenEdges), call it when the edges are computed.
+    // The graphs share the packed edges
+    void freeze();
+
     /* virtual */
     void setSlice(uint64_t sid)
     {
@@ -132,6 +168,7 @@ public:
     LLVMPointerAnalysis *getPTA() const { return PTA; }
 
 private:
+    // compute the control dependencies of this function
     void computePostDominators(bool addPostDomFrontiers = false);
     void computeControlExpression(bool addCDs = false);
 
@@ -143,6 +180,22 @@ private:
     // the graph). This is like if the value is a call-site,
     // then build subgraph or similar
     void handleInstruction(llvm::Value *val, LLVMNode *node);
+    // build (or find) the subgraphs of the functions called by @node
+    void handleCall(LLVMNode *node);
+
+    // the parts of build(llvm::Function *): the entry node and
+    // formal parameters, and then the blocks with the nodes. Only
+    // the first one touches the state shared with other graphs
+    // (when the calls are deferred)
+    void buildEntry(llvm::Function *func);
+    void buildBody(llvm::Function *func);
+    // create the exit node and block of @func before buildBody()
+    // (it creates them on its own otherwise), buildParallel() uses
+    // it to create the llvm values of the exits serially
+    void buildExit(llvm::Function *func);
+
+    // create the graph for @func that shares the state with this one
+    LLVMDependenceGraph *createSubgraph(llvm::Function *func);
 
     // convert llvm basic block to our basic block
     // That includes creating all the nodes and adding them
@@ -158,6 +211,13 @@ private:
     // all callnodes in this graph - forming call graph
     std::set<LLVMNode *> callNodes;
 
+    // do not build the subgraphs of called functions
+    // while building the graph, set by buildParallel()
+    bool defer_calls = false;
+
+    // the control dependencies of this function were computed
+    bool cd_computed = false;
+
     // when we want to slice according to some criterion,
     // we may gather the call-sites (good points for criterions)
     // while building the graph
@@ -166,16 +226,10 @@ private:
     // points-to information (if available)
     LLVMPointerAnalysis *PTA;
 
-    // control expression for this graph
-    ControlExpression CE;
-
     // verifier needs access to private elements
     friend class LLVMDGVerifier;
 };
 
-const std::map<llvm::Value *,
-               LLVMDependenceGraph *>& getConstructedFunctions();
-
 } // namespace dg
 
 #endif // _DEPENDENCE_GRAPH_H_
@@ -134,8 +134,8 @@ static void addGlobalsParams(LLVMDGParameters *params, LLVMNode *callNode, LLVMD
         LLVMDGParameter *act = params->findGlobal(val);
         // reuse or create the parameter
         if (!act) {
-            pin = new LLVMNode(val);
-            pout = new LLVMNode(val);
+            pin = new (callNode->getDG()->getNodesPool()) LLVMNode(val);
+            pout = new (callNode->getDG()->getNodesPool()) LLVMNode(val);
             pin->setDG(callNode->getDG());
             pout->setDG(callNode->getDG());
             params->addGlobal(val, pin, pout);
@@ -172,8 +172,8 @@ static void addDynMemoryParams(LLVMDGParameters *params, LLVMNode *callNode, LLV
 
         // reuse or create the parameter
         if (!act) {
-            pin = new LLVMNode(val);
-            pout = new LLVMNode(val);
+            pin = new (callNode->getDG()->getNodesPool()) LLVMNode(val);
+            pout = new (callNode->getDG()->getNodesPool()) LLVMNode(val);
             pin->setDG(callNode->getDG());
             pout->setDG(callNode->getDG());
             params->add(val, pin, pout);
@@ -217,8 +217,8 @@ static void addOperandsParams(LLVMDGParameters *params,
 
         LLVMDGParameter *ap = params->find(opval);
         if (!ap) {
-            in = new LLVMNode(opval);
-            out = new LLVMNode(opval);
+            in = new (callNode->getDG()->getNodesPool()) LLVMNode(opval);
+            out = new (callNode->getDG()->getNodesPool()) LLVMNode(opval);
             in->setDG(callNode->getDG());
             out->setDG(callNode->getDG());
             params->add(opval, in, out);
@@ -64,6 +64,22 @@ public:
         dont_touch.insert(n);
     }
 
+    // compute the control dependencies of a function only
+    // when the marking reaches it (see enterGraph)
+    void computeControlDependenciesLazily(CD_ALG alg)
+    {
+        lazy_cd = true;
+        cd_alg = alg;
+    }
+
+    /* virtual */
+    void enterGraph(DependenceGraph<LLVMNode> *graph)
+    {
+        if (lazy_cd)
+            static_cast<LLVMDependenceGraph *>(graph)
+                ->computeFunctionControlDependencies(cd_alg);
+    }
+
     /* virtual */
     bool removeNode(LLVMNode *node)
     {
@@ -135,7 +151,7 @@ public:
         return 0;
     }
 
-    uint32_t slice(LLVMDependenceGraph *,
+    uint32_t slice(LLVMDependenceGraph *dg,
                    LLVMNode *start, uint32_t sl_id = 0)
     {
         // mark nodes for slicing
@@ -145,9 +161,7 @@ public:
 
         // take every subgraph and slice it intraprocedurally
         // this includes the main graph
-        extern std::map<const llvm::Value *,
-                        LLVMDependenceGraph *> constructedFunctions;
-        for (auto& it : constructedFunctions) {
+        for (auto& it : dg->getConstructedFunctions()) {
             if (dontTouch(it.first->getName()))
                 continue;
 
@@ -236,7 +250,7 @@ private:
     {
         using namespace llvm;
 
-        LLVMBBlock *exitBB = new LLVMBBlock();
+        LLVMBBlock *exitBB = new (graph->getBlocksPool()) LLVMBBlock();
 
         Module *M = graph->getModule();
         LLVMContext& Ctx = M->getContext();
@@ -261,7 +275,7 @@ private:
                                     UndefValue::get(F->getReturnType()),
                                     block);
 
-        LLVMNode *newRet = new LLVMNode(RI);
+        LLVMNode *newRet = new (graph->getNodesPool()) LLVMNode(RI);
         graph->addNode(newRet);
 
         exitBB->append(newRet);
@@ -475,6 +489,10 @@ private:
             }
         }
 
+        // do not keep the removed nodes in the map of nodes,
+        // the later iterations over the graph would go over them
+        graph->getNodes()->compact();
+
         // create new CFG edges between blocks after slicing
         reconnectLLLVMBasicBlocks(graph);
 
@@ -611,6 +629,9 @@ private:
 
     // do not slice these functions at all
     std::set<const char *> dont_touch;
+
+    bool lazy_cd = false;
+    CD_ALG cd_alg = CD_ALG::CLASSIC;
 };
 } // namespace dg
 
@@ -1,4 +1,5 @@
 #include <map>
+#include <algorithm>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -35,6 +36,7 @@
 
 #include "analysis/PointsTo/PointerSubgraph.h"
 #include "analysis/DFS.h"
+#include "ADT/Parallel.h"
 
 using dg::analysis::rd::LLVMReachingDefinitions;
 using dg::analysis::rd::RDNode;
@@ -48,24 +50,26 @@ using namespace llvm;
 /// --------------------------------------------------
 namespace dg {
 
-static void handleInstruction(const Instruction *Inst, LLVMNode *node)
+void LLVMDefUseAnalysis::handleInstruction(const Instruction *Inst,
+                                           LLVMNode *node)
 {
     LLVMDependenceGraph *dg = node->getDG();
 
     for (auto I = Inst->op_begin(), E = Inst->op_end(); I != E; ++I) {
         LLVMNode *op = dg->getNode(*I);
         if (op)
-            op->addDataDependence(node);
+            addEdge(op, node);
     }
 }
 
-static void addReturnEdge(LLVMNode *callNode, LLVMDependenceGraph *subgraph)
+void LLVMDefUseAnalysis::addReturnEdge(LLVMNode *callNode,
+                                       LLVMDependenceGraph *subgraph)
 {
     // FIXME we may loose some accuracy here and
     // this edges causes that we'll go into subprocedure
     // even with summary edges
     if (!callNode->isVoidTy())
-        subgraph->getExit()->addDataDependence(callNode);
+        addEdge(subgraph->getExit(), callNode);
 }
 
 LLVMDefUseAnalysis::LLVMDefUseAnalysis(LLVMDependenceGraph *dg,
@@ -81,6 +85,44 @@ LLVMDefUseAnalysis::LLVMDefUseAnalysis(LLVMDependenceGraph *dg,
     assert(RD && "Need reaching definitions");
 }
 
+std::unique_lock<std::mutex> LLVMDefUseAnalysis::lockShared()
+{
+    // lock only when there are more threads
+    if (parallel)
+        return std::unique_lock<std::mutex>(lock);
+
+    return std::unique_lock<std::mutex>(lock, std::defer_lock);
+}
+
+void LLVMDefUseAnalysis::printerr(const char *msg, const llvm::Value *val)
+{
+    auto guard = lockShared();
+    llvmutils::printerr(msg, val);
+}
+
+PSNode *LLVMDefUseAnalysis::getPointsTo(const llvm::Value *val)
+{
+    // PTA may create nodes for constants on the fly
+    auto guard = lockShared();
+    return PTA->getPointsTo(val);
+}
+
+void LLVMDefUseAnalysis::addEdge(LLVMNode *from, LLVMNode *to)
+{
+    if (parallel) {
+        // the state of the function is not touched by other threads
+        auto it = functions.find(to->getDG());
+        assert(it != functions.end() && "Do not have the function");
+        it->second.edges.emplace_back(from, to);
+        return;
+    }
+
+    if (recorded)
+        recorded->emplace_back(from, to);
+
+    from->addDataDependence(to);
+}
+
 void LLVMDefUseAnalysis::handleInlineAsm(LLVMNode *callNode)
 {
     CallInst *CI = cast<CallInst>(callNode->getValue());
@@ -95,21 +137,20 @@ void LLVMDefUseAnalysis::handleInlineAsm(LLVMNode *callNode)
         LLVMNode *opNode = dg->getNode(opVal->stripInBoundsOffsets());
         if (!opNode) {
             // FIXME: ConstantExpr
-            llvmutils::printerr("WARN: unhandled inline asm operand: ", opVal);
+            printerr("WARN: unhandled inline asm operand: ", opVal);
             continue;
         }
 
         assert(opNode && "Do not have an operand for inline asm");
 
         // if nothing else, this call at least uses the operands
-        opNode->addDataDependence(callNode);
+        addEdge(opNode, callNode);
     }
 }
 
 void LLVMDefUseAnalysis::handleIntrinsicCall(LLVMNode *callNode,
                                              CallInst *CI)
 {
-    static std::set<Instruction *> warnings;
     IntrinsicInst *I = cast<IntrinsicInst>(CI);
     Value *dest, *src = nullptr;
 
@@ -143,12 +184,14 @@ void LLVMDefUseAnalysis::handleIntrinsicCall(LLVMNode *callNode,
             assert(I->getCalledFunction()->doesNotAccessMemory());
             return;
         case Intrinsic::stacksave:
-        case Intrinsic::stackrestore:
-            if (warnings.insert(CI).second)
+        case Intrinsic::stackrestore: {
+            auto guard = lockShared();
+            if (reported_unsupported.insert(CI).second)
                 llvmutils::printerr("WARN: stack save/restore not implemented", CI);
             return;
+        }
         default:
-            llvmutils::printerr("WARNING: unhandled intrinsic call", I);
+            printerr("WARNING: unhandled intrinsic call", I);
             // if it does not access memory, we can just add
             // direct def-use edges
             if (I->getCalledFunction()->doesNotAccessMemory())
@@ -179,7 +222,7 @@ void LLVMDefUseAnalysis::handleUndefinedCall(LLVMNode *callNode, CallInst *CI)
     // also assume that this function use all the memory that is passed
     // via the pointers
     for (int e = CI->getNumArgOperands(), i = 0; i < e; ++i) {
-        if (auto pts = PTA->getPointsTo(CI->getArgOperand(i))) {
+        if (auto pts = getPointsTo(CI->getArgOperand(i))) {
             // the passed memory may be used in the undefined
             // function on the unknown offset
             addDataDependence(callNode, CI, pts, Offset::UNKNOWN);
@@ -233,7 +276,7 @@ void LLVMDefUseAnalysis::handleCallInst(LLVMNode *node)
 
 // Add data dependence edges from all memory location that may write
 // to memory pointed by 'pts' to 'node'
-void LLVMDefUseAnalysis::addUnknownDataDependence(LLVMNode *node, PSNode *pts)
+void LLVMDefUseAnalysis::buildWriters()
 {
     // iterate over all nodes from ReachingDefinitions Subgraph. It is faster than
     // going over all llvm nodes and querying the pointer to analysis
@@ -249,20 +292,46 @@ void LLVMDefUseAnalysis::addUnknownDataDependence(LLVMNode *node, PSNode *pts)
         if (!rdVal)
             continue;
 
-        // does this store define some value that is in pts?
         for (const analysis::rd::DefSite& ds : rdnode->getDefines()) {
             llvm::Value *llvmVal = ds.target->getUserData<llvm::Value>();
             // is this an artificial node?
             if (!llvmVal)
                 continue;
 
-            // if these two sets have an over-lap, we must add the data dependence
-            for (const auto& ptr : pts->pointsTo)
-                if (ptr.target->getUserData<llvm::Value>() == llvmVal) {
-                    addDataDependence(node, rdVal);
-            }
+            // the def-sites of one target are next to each other
+            std::vector<llvm::Value *>& W = writers[llvmVal];
+            if (W.empty() || W.back() != rdVal)
+                W.push_back(rdVal);
         }
     }
+
+    writers_built = true;
+}
+
+void LLVMDefUseAnalysis::addUnknownDataDependence(LLVMNode *node, PSNode *pts)
+{
+    if (!writers_built) {
+        assert(!parallel && "The writers are built before going parallel");
+        buildWriters();
+    }
+
+    // add the data dependence on every store that may
+    // write to some memory that is in pts
+    const llvm::Value *last = nullptr;
+    for (const auto& ptr : pts->pointsTo) {
+        const llvm::Value *llvmVal = ptr.target->getUserData<llvm::Value>();
+        // the pointers to one target are next to each other
+        if (!llvmVal || llvmVal == last)
+            continue;
+
+        last = llvmVal;
+        auto it = writers.find(llvmVal);
+        if (it == writers.end())
+            continue;
+
+        for (llvm::Value *rdVal : it->second)
+            addDataDependence(node, rdVal);
+    }
 }
 
 void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, llvm::Value *rdval)
@@ -281,14 +350,14 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, llvm::Value *rdval)
         assert(graph != dg && "Cannot find a node");
         rdnode = graph->getNode(rdval);
         if (!rdnode) {
-            llvmutils::printerr("[DU] error: DG doesn't have val: ", rdval);
+            printerr("[DU] error: DG doesn't have val: ", rdval);
             abort();
             return;
         }
     }
 
     assert(rdnode);
-    rdnode->addDataDependence(node);
+    addEdge(rdnode, node);
 }
 
 
@@ -299,12 +368,37 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, RDNode *rd)
     addDataDependence(node, rdval);
 }
 
+const std::vector<RDNode *>&
+LLVMDefUseAnalysis::getReachingDefinitions(LLVMNode *node,
+                                           RDNode *mem, RDNode *target,
+                                           const Offset& off,
+                                           const Offset& len)
+{
+    // the queries are made at the nodes of @node's function,
+    // so every function can have its own cache
+    RDCache& cache = parallel ? functions.find(node->getDG())->second.rd_cache
+                              : rd_cache;
+
+    RDQuery query{mem, target, *off, *len};
+    auto it = cache.find(query);
+    if (it != cache.end())
+        return it->second;
+
+    // the queries of all the analyses are thread-safe
+    std::set<RDNode *> defs;
+    mem->getReachingDefinitions(target, off, len, defs);
+
+    return cache.emplace(query,
+                            std::vector<RDNode *>(defs.begin(), defs.end()))
+                    .first->second;
+}
+
 // \param mem   current reaching definitions point
 void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, PSNode *pts,
                                            RDNode *mem, uint64_t size)
 {
     using namespace dg::analysis;
-    static std::set<const llvm::Value *> reported_mappings;
+    bool added_unknown = false;
 
     for (const pta::Pointer& ptr : pts->pointsTo) {
         if (!ptr.isValid())
@@ -318,6 +412,7 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, PSNode *pts,
 
         RDNode *val = RD->getNode(llvmVal);
         if(!val) {
+            auto guard = lockShared();
             if (reported_mappings.insert(llvmVal).second)
                 llvmutils::printerr("DEF-USE: no information for: ", llvmVal);
 
@@ -325,28 +420,29 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node, PSNode *pts,
             continue;
         }
 
-        std::set<RDNode *> defs;
         // Get even reaching definitions for UNKNOWN_MEMORY.
         // Since those can be ours definitions, we must add them always
-        mem->getReachingDefinitions(rd::UNKNOWN_MEMORY, Offset::UNKNOWN,
-                                    Offset::UNKNOWN, defs);
-        if (!defs.empty()) {
-            for (RDNode *rd : defs) {
+        // (they are the same for all the pointers)
+        if (!added_unknown) {
+            added_unknown = true;
+            for (RDNode *rd : getReachingDefinitions(node, mem,
+                                                     rd::UNKNOWN_MEMORY,
+                                                     Offset::UNKNOWN,
+                                                     Offset::UNKNOWN)) {
                 assert(!rd->isUnknown() && "Unknown memory defined at unknown location?");
                 if (rd->getType() != RDNodeType::PHI)
                     addDataDependence(node, rd);
             }
-
-            defs.clear();
         }
 
-        mem->getReachingDefinitions(val, ptr.offset, size, defs);
+        const std::vector<RDNode *>& defs
+            = getReachingDefinitions(node, mem, val, ptr.offset, size);
         if (defs.empty()) {
             llvm::GlobalVariable *GV
                 = llvm::dyn_cast<llvm::GlobalVariable>(llvmVal);
             if (!GV || !GV->hasInitializer()) {
-                static std::set<const llvm::Value *> reported;
-                if (reported.insert(llvmVal).second) {
+                auto guard = lockShared();
+                if (reported_no_defs.insert(llvmVal).second) {
                     llvm::errs() << "No reaching definition for: " << *llvmVal;
                     const llvm::Value *val = mem->getUserData<llvm::Value>();
                     if (val)
@@ -382,9 +478,9 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node,
                                            uint64_t size)
 {
     // get points-to information for the operand
-    PSNode *pts = PTA->getPointsTo(ptrOp);
+    PSNode *pts = getPointsTo(ptrOp);
     if (!pts) {
-        llvmutils::printerr("[DU] error: no points-to: ", ptrOp);
+        printerr("[DU] error: no points-to: ", ptrOp);
         return;
     }
 
@@ -402,7 +498,7 @@ void LLVMDefUseAnalysis::addDataDependence(LLVMNode *node,
     // all the reaching definitions
     RDNode *mem = RD->getMapping(where);
     if(!mem) {
-        llvmutils::printerr("[DU] error: don't have mapping: ", where);
+        printerr("[DU] error: don't have mapping: ", where);
         return;
     }
 
@@ -420,11 +516,38 @@ static uint64_t getAllocatedSize(llvm::Type *Ty, const llvm::DataLayout *DL)
     return DL->getTypeAllocSize(Ty);
 }
 
+uint64_t LLVMDefUseAnalysis::getTypeSize(llvm::Type *Ty)
+{
+    if (parallel) {
+        auto it = type_sizes.find(Ty);
+        assert(it != type_sizes.end() && "Did not compute the size");
+        return it->second;
+    }
+
+    return getAllocatedSize(Ty, DL);
+}
+
+void LLVMDefUseAnalysis::computeTypeSizes(
+                const std::vector<std::vector<LLVMBBlock *>>& blocks)
+{
+    for (const auto& F : blocks) {
+        for (LLVMBBlock *BB : F) {
+            for (LLVMNode *node : BB->getNodes()) {
+                if (LoadInst *Inst = dyn_cast<LoadInst>(node->getKey())) {
+                    llvm::Type *Ty = Inst->getType();
+                    if (type_sizes.count(Ty) == 0)
+                        type_sizes.emplace(Ty, getAllocatedSize(Ty, DL));
+                }
+            }
+        }
+    }
+}
+
 void LLVMDefUseAnalysis::handleLoadInst(llvm::LoadInst *Inst, LLVMNode *node)
 {
     using namespace dg::analysis;
 
-    uint64_t size = getAllocatedSize(Inst->getType(), DL);
+    uint64_t size = getTypeSize(Inst->getType());
     addDataDependence(node, Inst, Inst->getPointerOperand(), size);
 }
 
@@ -447,4 +570,76 @@ bool LLVMDefUseAnalysis::runOnNode(LLVMNode *node, LLVMNode *prev)
     return false;
 }
 
+void LLVMDefUseAnalysis::collectEdges(unsigned threads,
+                                      std::vector<Edge>& edges)
+{
+    using namespace dg::analysis;
+
+    // get the blocks that run() would go over, grouped by functions
+    std::vector<std::vector<LLVMBBlock *>> blocks;
+    std::unordered_map<const LLVMDependenceGraph *, size_t> idx;
+    BBlockDFS<LLVMNode> DFS(DFS_BB_CFG | DFS_INTERPROCEDURAL);
+    DFS.run(dg->getEntryBB(),
+            [&blocks, &idx](LLVMBBlock *BB, void *) {
+                auto it = idx.emplace(BB->getDG(), blocks.size());
+                if (it.second)
+                    blocks.emplace_back();
+                blocks[it.first->second].push_back(BB);
+            }, nullptr);
+
+    for (auto& it : idx)
+        functions[it.first];
+
+    // the workers only read these
+    computeTypeSizes(blocks);
+    if (!writers_built)
+        buildWriters();
+
+    parallel = true;
+    ADT::parallelFor(blocks.size(), ADT::getThreadsNum(threads),
+                     [this, &blocks](size_t i) {
+                         for (LLVMBBlock *BB : blocks[i])
+                             runOnBlock(BB);
+                     });
+    parallel = false;
+
+    for (auto& it : functions)
+        edges.insert(edges.end(), it.second.edges.begin(),
+                     it.second.edges.end());
+    functions.clear();
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+}
+
+void LLVMDefUseAnalysis::addEdges(const std::vector<Edge>& edges)
+{
+    for (const Edge& e : edges)
+        e.first->addDataDependence(e.second);
+}
+
+void LLVMDefUseAnalysis::runParallel(unsigned threads)
+{
+    std::vector<Edge> edges;
+    collectEdges(threads, edges);
+    addEdges(edges);
+}
+
+bool LLVMDefUseAnalysis::checkParallel(unsigned threads)
+{
+    std::vector<Edge> edges;
+    collectEdges(threads, edges);
+    addEdges(edges);
+
+    std::vector<Edge> serial;
+    recorded = &serial;
+    run();
+    recorded = nullptr;
+
+    std::sort(serial.begin(), serial.end());
+    serial.erase(std::unique(serial.begin(), serial.end()), serial.end());
+
+    return serial == edges;
+}
+
 } // namespace dg
@@ -1,6 +1,13 @@
 #ifndef _LLVM_DEF_USE_ANALYSIS_H_
 #define _LLVM_DEF_USE_ANALYSIS_H_
 
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <utility>
+
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/DataLayout.h>
@@ -27,6 +34,94 @@ class LLVMDefUseAnalysis : public analysis::DataFlowAnalysis<LLVMNode>
     LLVMPointerAnalysis *PTA;
     const llvm::DataLayout *DL;
     bool assume_pure_functions;
+
+    // query on reaching definitions of memory at a RD node.
+    // Many loads share the RD node and the memory they read
+    struct RDQuery {
+        analysis::rd::RDNode *mem;
+        analysis::rd::RDNode *target;
+        uint64_t offset;
+        uint64_t len;
+
+        bool operator==(const RDQuery& oth) const {
+            return mem == oth.mem && target == oth.target
+                   && offset == oth.offset && len == oth.len;
+        }
+    };
+
+    struct RDQueryHash {
+        size_t operator()(const RDQuery& q) const {
+            size_t h = std::hash<analysis::rd::RDNode *>()(q.mem);
+            h = h * 31 + std::hash<analysis::rd::RDNode *>()(q.target);
+            h = h * 31 + std::hash<uint64_t>()(q.offset);
+            return h * 31 + std::hash<uint64_t>()(q.len);
+        }
+    };
+
+    using RDCache = std::unordered_map<RDQuery,
+                                       std::vector<analysis::rd::RDNode *>,
+                                       RDQueryHash>;
+
+    // the answered queries, the reaching definitions
+    // do not change while we are adding the edges
+    RDCache rd_cache;
+
+    const std::vector<analysis::rd::RDNode *>&
+    getReachingDefinitions(LLVMNode *node,
+                           analysis::rd::RDNode *mem,
+                           analysis::rd::RDNode *target,
+                           const analysis::Offset& off,
+                           const analysis::Offset& len);
+
+    // memory -> the stores that may write to it,
+    // built when it is needed for the first time
+    std::unordered_map<const llvm::Value *, std::vector<llvm::Value *>> writers;
+    bool writers_built = false;
+
+    void buildWriters();
+
+    // the sizes of the loaded types. DataLayout caches the layouts
+    // of structures and it is not thread-safe, so the sizes
+    // are computed before the functions are processed in parallel
+    std::unordered_map<const llvm::Type *, uint64_t> type_sizes;
+
+    uint64_t getTypeSize(llvm::Type *Ty);
+    void computeTypeSizes(
+            const std::vector<std::vector<BBlock<LLVMNode> *>>& blocks);
+
+    using Edge = std::pair<LLVMNode *, LLVMNode *>;
+
+    // the edges and the answered queries of one function when
+    // the functions are processed in parallel. The queries are
+    // made at the nodes of the function, so they are not shared
+    struct FunctionState {
+        std::vector<Edge> edges;
+        RDCache rd_cache;
+    };
+
+    // set while the functions are processed in parallel
+    bool parallel = false;
+    std::unordered_map<const LLVMDependenceGraph *, FunctionState> functions;
+    // guards the pointer analysis and the reports
+    // when the functions are processed in parallel
+    std::mutex lock;
+    // the values that were already reported, so that
+    // every problem is reported only once
+    std::set<const llvm::Value *> reported_unsupported;
+    std::set<const llvm::Value *> reported_mappings;
+    std::set<const llvm::Value *> reported_no_defs;
+    // if set, the edges added by run() are stored here too
+    std::vector<Edge> *recorded = nullptr;
+
+    std::unique_lock<std::mutex> lockShared();
+    void printerr(const char *msg, const llvm::Value *val);
+    PSNode *getPointsTo(const llvm::Value *val);
+
+    // add the edge @from -> @to, @to is a node of the processed function
+    void addEdge(LLVMNode *from, LLVMNode *to);
+    // get the edges of all functions sorted and without duplicates
+    void collectEdges(unsigned threads, std::vector<Edge>& edges);
+    static void addEdges(const std::vector<Edge>& edges);
 public:
     LLVMDefUseAnalysis(LLVMDependenceGraph *dg,
                        LLVMReachingDefinitions *rd,
@@ -36,6 +131,15 @@ public:
 
     /* virtual */
     bool runOnNode(LLVMNode *node, LLVMNode *prev);
+
+    // do the same as run(), but process the functions using
+    // @threads threads (0 means all). The edges are collected
+    // and added to the graph at once when all functions are done
+    void runParallel(unsigned threads);
+
+    // add the edges in parallel like runParallel() and then
+    // once more by run(), return true if both ways found the same edges
+    bool checkParallel(unsigned threads);
 private:
     void addDataDependence(LLVMNode *node,
                            analysis::pta::PSNode *pts,
@@ -57,6 +161,8 @@ private:
 
     void addUnknownDataDependence(LLVMNode *node, PSNode *pts);
 
+    void handleInstruction(const llvm::Instruction *Inst, LLVMNode *node);
+    void addReturnEdge(LLVMNode *callNode, LLVMDependenceGraph *subgraph);
     void handleLoadInst(llvm::LoadInst *, LLVMNode *);
     void handleCallInst(LLVMNode *);
     void handleInlineAsm(LLVMNode *callNode);
@@ -3,6 +3,7 @@
 
 #include <unordered_map>
 #include <memory>
+#include <set>
 
 #include <llvm/Support/raw_os_ostream.h>
 #include <llvm/IR/Instructions.h>
@@ -50,6 +51,10 @@ protected:
     // so that we can delete it later)
     std::vector<RDNode *> dummy_nodes;
 
+    // the pointers whose targets do not have a node, so that
+    // every such pointer is reported only once
+    std::set<const llvm::Value *> reported_no_target;
+
 public:
     LLVMRDBuilder(const llvm::Module *m,
                   dg::LLVMPointerAnalysis *p,
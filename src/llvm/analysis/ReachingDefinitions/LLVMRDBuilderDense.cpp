@@ -297,8 +297,7 @@ RDNode *LLVMRDBuilderDense::createStore(const llvm::Instruction *Inst)
         if (!ptrNode) {
             // keeping such set is faster then printing it all to terminal
             // ... and we don't flood the terminal that way
-            static std::set<const llvm::Value *> warned;
-            if (warned.insert(ptrVal).second) {
+            if (reported_no_target.insert(ptrVal).second) {
                 llvm::errs() << *ptrVal << "\n";
                 llvm::errs() << "Don't have created node for pointer's target\n";
             }
@@ -344,8 +344,7 @@ std::vector<DefSite> LLVMRDBuilderSemisparse::getPointsTo(const llvm::Value *val
         if (!ptrNode) {
             // keeping such set is faster then printing it all to terminal
             // ... and we don't flood the terminal that way
-            static std::set<const llvm::Value *> warned;
-            if (warned.insert(ptrVal).second) {
+            if (reported_no_target.insert(ptrVal).second) {
                 llvm::errs() << *ptrVal << "\n";
                 llvm::errs() << "Don't have created node for pointer's target\n";
             }
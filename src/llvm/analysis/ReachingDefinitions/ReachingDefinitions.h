@@ -11,6 +11,9 @@
 
 #include "llvm/MemAllocationFuncs.h"
 #include "analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/BlockReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/BitvectorReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/DemandReachingDefinitions.h"
 #include "analysis/ReachingDefinitions/SemisparseRda.h"
 #include "llvm/analysis/PointsTo/PointsTo.h"
 #include "llvm/analysis/ReachingDefinitions/LLVMRDBuilder.h"
@@ -31,6 +34,21 @@ namespace detail {
         struct BuilderSelector<SemisparseRda> {
             using BuilderT = LLVMRDBuilderSemisparse;
         };
+
+    template <typename Rda>
+        struct RdaCreator {
+            static Rda *create(RDNode *root, unsigned) {
+                return new Rda(root);
+            }
+        };
+
+    // only the semi-sparse analysis can use more threads
+    template <>
+        struct RdaCreator<SemisparseRda> {
+            static SemisparseRda *create(RDNode *root, unsigned threads) {
+                return new SemisparseRda(root, threads);
+            }
+        };
 }
 
 class LLVMReachingDefinitions
@@ -43,15 +61,17 @@ class LLVMReachingDefinitions
     bool strong_update_unknown;
     bool pure_funs;
     Offset max_set_size;
+    unsigned threads;
 
 public:
     LLVMReachingDefinitions(const llvm::Module *m,
                             dg::LLVMPointerAnalysis *pta,
                             bool strong_updt_unknown = false,
                             bool pure_funs = false,
-                            Offset max_set_sz = Offset::UNKNOWN)
+                            Offset max_set_sz = Offset::UNKNOWN,
+                            unsigned threads = 1)
         : m(m), pta(pta), strong_update_unknown(strong_updt_unknown),
-        pure_funs(pure_funs), max_set_size(max_set_sz) {}
+        pure_funs(pure_funs), max_set_size(max_set_sz), threads(threads) {}
 
     /**
      * Template parameters:
@@ -66,7 +86,7 @@ public:
         builder = std::unique_ptr<LLVMRDBuilder>(new BuilderT(m, pta, pure_funs));
         root = builder->build();
 
-        RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(new RdaType(root));
+        RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(detail::RdaCreator<RdaType>::create(root, threads));
         RDA->run();
     }
 
@@ -74,6 +94,12 @@ public:
         return root;
     }
 
+    const ReachingDefinitionsStatistics& getStatistics() const
+    {
+        assert(RDA);
+        return RDA->getStatistics();
+    }
+
     RDNode *getNode(const llvm::Value *val)
     {
         return builder->getNode(val);
@@ -109,6 +135,15 @@ public:
     {
         return n->getReachingDefinitions(n, off, len, ret);
     }
+
+    // get definitions of memory [mem + off, mem + off + len]
+    // that reach the node @where
+    size_t getReachingDefinitions(RDNode *where, RDNode *mem,
+                                  const Offset& off, const Offset& len,
+                                  std::set<RDNode *>& ret)
+    {
+        return where->getReachingDefinitions(mem, off, len, ret);
+    }
 };
 
 
@@ -4,8 +4,19 @@
 
 #include "test-runner.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+#include <set>
+#include <map>
+
 #include "ADT/Queue.h"
+#include "ADT/SortedVectorSet.h"
+#include "ADT/HashMap.h"
+#include "ADT/ObjectPool.h"
 #include "analysis/ReachingDefinitions/RDMap.h"
+#include "analysis/ReachingDefinitions/Srg/DefTable.h"
 
 using namespace dg::ADT;
 using dg::analysis::Offset;
@@ -150,6 +161,394 @@ public:
 };
 
 
+class TestSortedVectorSet : public Test
+{
+public:
+    TestSortedVectorSet() : Test("sorted vector set test")
+    {}
+
+    void test()
+    {
+        SortedVectorSet<int> S;
+        check(S.empty(), "empty set not empty");
+        check(S.insert(3).second, "did not insert 3");
+        check(S.insert(1).second, "did not insert 1");
+        check(S.insert(2).second, "did not insert 2");
+        check(!S.insert(2).second, "inserted 2 twice");
+        check(S.size() == 3, "wrong size");
+        check(std::is_sorted(S.begin(), S.end()), "set not sorted");
+        check(S.contains(1) && S.contains(2) && S.contains(3), "missing value");
+        check(!S.contains(4), "contains value that was not inserted");
+
+        check(S.erase(2) == 1, "did not erase 2");
+        check(S.erase(2) == 0, "erased 2 twice");
+        check(!S.contains(2), "contains erased value");
+
+        int vals[] = {5, 4, 1, 4};
+        SortedVectorSet<int> S2(vals, vals + 4);
+        check(S2.size() == 3, "wrong size after range insert");
+        check(!S.isSubsetOf(S2), "{1, 3} is not subset of {1, 4, 5}");
+        check(S2.merge(S), "merge did not change the set");
+        check(!S2.merge(S), "merge changed the set twice");
+        check(S.isSubsetOf(S2), "{1, 3} is a subset of {1, 3, 4, 5}");
+        check(S2.intersect(S), "intersect did not change the set");
+        check(S2 == S, "intersection is wrong");
+
+        checkSmall<int, 4>();
+        checkSmall<uint64_t, 2>();
+    }
+
+    // compare the set with inline elements to std::set
+    // on random operations that go over the inline size
+    template <typename T, unsigned int N>
+    void checkSmall()
+    {
+        using SetT = SortedVectorSet<T, N>;
+        for (int round = 0; round < 200; ++round) {
+            SetT A, B;
+            std::set<T> refA, refB;
+            for (int i = 0; i < 20; ++i) {
+                T v = static_cast<T>(rand() % 12);
+                switch (rand() % 4) {
+                case 0:
+                    check(A.insert(v).second == refA.insert(v).second,
+                          "wrong result of insert");
+                    break;
+                case 1:
+                    check(A.erase(v) == refA.erase(v), "wrong result of erase");
+                    break;
+                case 2:
+                    B.insert(v);
+                    refB.insert(v);
+                    break;
+                default:
+                    check(A.contains(v) == (refA.count(v) > 0),
+                          "wrong result of contains");
+                }
+            }
+
+            check(std::equal(A.begin(), A.end(), refA.begin())
+                  && A.size() == refA.size(), "wrong elements");
+
+            SetT C(A);
+            check(C == A, "copy differs");
+            C.swap(B);
+            check(C.size() == refB.size() && B == A, "swap is wrong");
+
+            if (rand() % 2) {
+                B.merge(C);
+                refA.insert(refB.begin(), refB.end());
+            } else {
+                B.intersect(C);
+                std::set<T> tmp;
+                std::set_intersection(refA.begin(), refA.end(),
+                                      refB.begin(), refB.end(),
+                                      std::inserter(tmp, tmp.end()));
+                refA.swap(tmp);
+            }
+
+            check(B.size() == refA.size()
+                  && std::equal(B.begin(), B.end(), refA.begin()),
+                  "wrong merge or intersection");
+        }
+    }
+};
+
+class TestHashMap : public Test
+{
+public:
+    TestHashMap() : Test("hash map test")
+    {}
+
+    void test()
+    {
+        ADT::HashMap<int, int> M;
+        check(M.empty(), "empty map not empty");
+        check(M.insert(std::make_pair(3, 30)).second, "did not insert 3");
+        check(M.insert(std::make_pair(1, 10)).second, "did not insert 1");
+        check(!M.insert(std::make_pair(3, 0)).second, "inserted 3 twice");
+        M[2] = 20;
+        check(M.size() == 3, "wrong size");
+        check(M.find(3)->second == 30, "insert overwrote the value");
+
+        // the elements are in the order of insertion
+        int order[] = {3, 1, 2};
+        int i = 0;
+        for (auto& it : M)
+            check(it.first == order[i++], "wrong order of elements");
+
+        // erasing while iterating
+        for (auto I = M.begin(), E = M.end(); I != E;) {
+            auto cur = I++;
+            if (cur->first != 2)
+                M.erase(cur);
+        }
+        check(M.size() == 1 && M.begin()->first == 2, "wrong erase");
+        check(M.count(3) == 0 && M.find(1) == M.end(), "contains erased key");
+
+        // compare to std::map on random operations,
+        // so that the index grows and contains erased slots
+        srand(11);
+        ADT::HashMap<int, int> H;
+        std::map<int, int> ref;
+        std::vector<std::pair<int, int>> inserted;
+        for (int n = 0; n < 20000; ++n) {
+            int k = rand() % 1000;
+            switch (rand() % 3) {
+            case 0:
+                check(H.erase(k) == ref.erase(k), "wrong result of erase");
+                break;
+            case 1:
+                check(H.count(k) == ref.count(k), "wrong result of count");
+                break;
+            default:
+                if (H.insert(std::make_pair(k, n)).second) {
+                    check(ref.emplace(k, n).second, "inserted existing key");
+                    inserted.push_back(std::make_pair(k, n));
+                }
+            }
+        }
+
+        // the keys that were erased and inserted again
+        // are at the position of the last insertion
+        std::vector<std::pair<int, int>> expected;
+        for (auto& it : inserted) {
+            auto r = ref.find(it.first);
+            if (r != ref.end() && r->second == it.second)
+                expected.push_back(it);
+        }
+
+        check(H.size() == ref.size() && expected.size() == ref.size(),
+              "wrong size");
+        check(std::equal(H.begin(), H.end(), expected.begin()),
+              "wrong elements or order");
+
+        compaction();
+    }
+
+    // the erased elements are dropped, but the order stays
+    void compaction()
+    {
+        ADT::HashMap<int, int> H;
+        std::vector<std::pair<int, int>> expected;
+        for (int i = 0; i < 1000; ++i)
+            H.insert(std::make_pair((i * 7919) % 1000, i));
+
+        // erase 9/10 of the elements and drop them by compact()
+        for (auto I = H.begin(), E = H.end(); I != E;) {
+            auto cur = I++;
+            if (cur->second % 10 != 0)
+                H.erase(cur);
+            else
+                expected.push_back(*cur);
+        }
+
+        H.compact();
+        check(H.size() == expected.size()
+              && std::equal(H.begin(), H.end(), expected.begin()),
+              "compact() changed the elements or order");
+        for (auto& it : expected)
+            check(H.find(it.first) != H.end(), "lost a key by compact()");
+
+        // erase again and let insert() drop the erased elements
+        for (auto I = H.begin(), E = H.end(); I != E;) {
+            auto cur = I++;
+            if (cur->second % 30 != 0)
+                H.erase(cur);
+        }
+
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [](const std::pair<int, int>& kv) {
+                                          return kv.second % 30 != 0;
+                                      }),
+                       expected.end());
+
+        expected.push_back(std::make_pair(1000, 1000));
+        H.insert(expected.back());
+        check(H.size() == expected.size()
+              && std::equal(H.begin(), H.end(), expected.begin()),
+              "insert() changed the elements or order");
+        for (auto& it : expected)
+            check(H.find(it.first) != H.end(), "lost a key by insert()");
+    }
+};
+
+class TestDefTable : public Test
+{
+public:
+    TestDefTable() : Test("def table test")
+    {}
+
+    void test()
+    {
+        using analysis::rd::srg::detail::DefTable;
+
+        DefTable<int> T;
+        check(T.find(0, 0) == nullptr, "found a value in empty table");
+
+        T.get(1, 2) = 12;
+        T.get(2, 1) = 21;
+        check(T.size() == 2, "wrong size");
+        check(T.find(1, 2) && *T.find(1, 2) == 12, "wrong value of (1, 2)");
+        check(T.find(2, 1) && *T.find(2, 1) == 21, "wrong value of (2, 1)");
+        check(T.find(1, 1) == nullptr, "found a missing pair");
+        check(T.size() == 2, "find inserted a value");
+
+        // the references stay valid when the table grows
+        int& ref = T.get(1, 2);
+        for (unsigned i = 0; i < 1000; ++i)
+            T.get(i + 10, i) = i;
+        check(&ref == T.find(1, 2) && ref == 12, "the value moved");
+
+        // compare to std::map on random pairs
+        srand(7);
+        DefTable<int> R;
+        std::map<std::pair<unsigned, unsigned>, int> expected;
+        for (int n = 0; n < 20000; ++n) {
+            unsigned var = rand() % 300;
+            unsigned block = rand() % 300;
+            if (rand() % 2) {
+                R.get(var, block) = n;
+                expected[std::make_pair(var, block)] = n;
+            } else {
+                auto it = expected.find(std::make_pair(var, block));
+                int *v = R.find(var, block);
+                check((it == expected.end()) == (v == nullptr),
+                      "wrong result of find");
+                check(!v || *v == it->second, "wrong value");
+            }
+        }
+        check(R.size() == expected.size(), "wrong size");
+
+        T.clear();
+        check(T.size() == 0 && T.find(1, 2) == nullptr, "clear did not clear");
+        T.get(1, 2) = 3;
+        check(*T.find(1, 2) == 3, "table broken after clear");
+    }
+};
+
+class TestObjectPool : public Test
+{
+public:
+    TestObjectPool() : Test("object pool test")
+    {}
+
+    struct Obj : public ADT::PoolAllocated {
+        uint64_t vals[5];
+        Obj(uint64_t v) { for (auto& x : vals) x = v; }
+    };
+
+    struct BigObj : public Obj {
+        uint64_t more[10];
+        BigObj() : Obj(0) {}
+    };
+
+    void test()
+    {
+        ADT::ObjectPool pool(sizeof(Obj));
+        std::vector<Obj *> objs;
+        for (uint64_t i = 0; i < 1000; ++i)
+            objs.push_back(new (pool) Obj(i));
+
+        check(pool.liveObjects() == 1000, "wrong number of objects");
+        for (uint64_t i = 0; i < 1000; ++i)
+            check(objs[i]->vals[0] == i && objs[i]->vals[4] == i,
+                  "objects overlap");
+
+        // the freed memory is reused
+        size_t slabs = pool.slabsNum();
+        for (size_t i = 0; i < objs.size(); i += 2)
+            delete objs[i];
+        check(pool.liveObjects() == 500, "wrong number of objects");
+        for (size_t i = 0; i < objs.size(); i += 2)
+            objs[i] = new (pool) Obj(i);
+        check(pool.slabsNum() == slabs, "did not reuse the memory");
+
+        // objects that do not fit and objects
+        // allocated by plain new go to the heap
+        Obj *big = new (pool) BigObj();
+        Obj *heap = new Obj(7);
+        check(pool.liveObjects() == 1000, "heap objects in the pool");
+        delete static_cast<BigObj *>(big);
+        delete heap;
+
+        for (Obj *o : objs)
+            delete o;
+        check(pool.liveObjects() == 0, "wrong number of objects");
+    }
+};
+
+class TestSetKernels : public Test
+{
+public:
+    TestSetKernels() : Test("SIMD set kernels test")
+    {}
+
+    static std::vector<uint64_t> randomSet(size_t n, uint64_t range)
+    {
+        std::vector<uint64_t> ret;
+        for (size_t i = 0; i < n; ++i)
+            ret.push_back(static_cast<uint64_t>(rand()) % range);
+
+        // use also the values that differ in the sign bit
+        if (n > 0)
+            ret.push_back(~static_cast<uint64_t>(0) - ret[0]);
+
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+        return ret;
+    }
+
+    void checkLevel(kernels::Level level,
+                    const std::vector<uint64_t>& a,
+                    const std::vector<uint64_t>& b)
+    {
+        std::vector<uint64_t> ref, out(a.size() + b.size());
+
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                       std::back_inserter(ref));
+        size_t n = kernels::setUnion(a.data(), a.size(), b.data(), b.size(),
+                                     out.data(), level);
+        check(n == ref.size() && std::equal(ref.begin(), ref.end(), out.begin()),
+              "wrong union");
+
+        ref.clear();
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                              std::back_inserter(ref));
+        n = kernels::setIntersection(a.data(), a.size(), b.data(), b.size(),
+                                     out.data(), level);
+        check(n == ref.size() && std::equal(ref.begin(), ref.end(), out.begin()),
+              "wrong intersection");
+
+        check(kernels::isSubset(a.data(), a.size(), b.data(), b.size(), level)
+              == std::includes(b.begin(), b.end(), a.begin(), a.end()),
+              "wrong subset check");
+        check(kernels::isSubset(ref.data(), ref.size(), a.data(), a.size(), level),
+              "intersection must be a subset");
+    }
+
+    void test()
+    {
+        std::vector<kernels::Level> levels = { kernels::Level::SCALAR };
+        if (kernels::activeLevel() != kernels::Level::SCALAR)
+            levels.push_back(kernels::Level::SSE42);
+        if (kernels::activeLevel() == kernels::Level::AVX2)
+            levels.push_back(kernels::Level::AVX2);
+
+        srand(7);
+        for (unsigned i = 0; i < 200; ++i) {
+            auto a = randomSet(rand() % 40, 1 + rand() % 100);
+            auto b = randomSet(rand() % 40, 1 + rand() % 100);
+            for (kernels::Level level : levels) {
+                checkLevel(level, a, b);
+                checkLevel(level, a, a);
+                checkLevel(level, a, std::vector<uint64_t>());
+            }
+        }
+    }
+};
+
+
 
 }; // namespace tests
 }; // namespace dg
@@ -163,6 +562,11 @@ int main()
     Runner.add(new TestFIFO());
     Runner.add(new TestPrioritySet());
     Runner.add(new TestIntervalsHandling());
+    Runner.add(new TestSortedVectorSet());
+    Runner.add(new TestHashMap());
+    Runner.add(new TestDefTable());
+    Runner.add(new TestObjectPool());
+    Runner.add(new TestSetKernels());
 
     return Runner();
 }
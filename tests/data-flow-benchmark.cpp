@@ -0,0 +1,81 @@
+#include <vector>
+#include <string>
+
+#include "test-dg.h"
+#include "analysis/DataFlowAnalysis.h"
+#include "../tools/TimeMeasure.h"
+
+using namespace dg;
+using namespace dg::tests;
+
+// visit every node of the blocks, the analysis goes
+// over the blocks @rounds times and then reaches the fixpoint
+class CountingAnalysis : public analysis::DataFlowAnalysis<TestNode>
+{
+    int rounds;
+
+public:
+    CountingAnalysis(TestBBlock *B, int rounds)
+    : analysis::DataFlowAnalysis<TestNode>(B), rounds(rounds) {}
+
+    /* virtual */
+    bool runOnNode(TestNode *n, TestNode *prev)
+    {
+        (void) prev;
+        return ++n->counter < rounds;
+    }
+};
+
+// create a cycle of @blocks_num blocks with
+// @block_size nodes and run the analysis on it
+void run(int blocks_num, int block_size, int rounds)
+{
+    TestDG dg;
+    std::vector<TestBBlock *> blocks;
+    int key = 0;
+
+    for (int i = 0; i < blocks_num; ++i) {
+        TestBBlock *B = new (dg.getBlocksPool()) TestBBlock();
+        for (int j = 0; j < block_size; ++j) {
+            TestNode *n = new (dg.getNodesPool()) TestNode(key++);
+            dg.addNode(n);
+            B->append(n);
+        }
+
+        if (!blocks.empty())
+            blocks.back()->addSuccessor(B);
+        blocks.push_back(B);
+    }
+
+    blocks.back()->addSuccessor(blocks.front());
+
+    CountingAnalysis DFA(blocks.front(), rounds);
+    DFA.run();
+
+    for (auto& it : dg)
+        delete it.second;
+    for (TestBBlock *B : blocks)
+        delete B;
+}
+
+void test(int blocks_num, int block_size, int rounds)
+{
+    dg::debug::TimeMeasure tm;
+    std::string msg = "[" + std::to_string(rounds) + " rounds] ";
+    msg += std::to_string(blocks_num) + " blocks of ";
+    msg += std::to_string(block_size) + " nodes -- ";
+
+    tm.start();
+    run(blocks_num, block_size, rounds);
+    tm.stop();
+    tm.report(msg.c_str());
+}
+
+int main()
+{
+    test(1000, 1, 1000);
+    test(1000, 10, 100);
+    test(1000, 100, 10);
+    test(100, 1000, 10);
+    test(10, 10000, 10);
+}
@@ -38,6 +38,8 @@ public:
     {
         run_nums_test();
         run_nums_test_interproc();
+        run_rpo_test();
+        run_return_test();
     };
 
     TestDG *create_circular_graph(size_t nodes_num)
@@ -129,26 +131,128 @@ public:
         check(stats.getIterationsNum() == 1, "did wrong number of iterations: %d",
               stats.getIterationsNum());
 
+        // the blocks go in reverse post-order, so only the entry block
+        // has a changed predecessor after the first iteration
         DataFlowA dfa2(d->getEntryBB(), one_change);
         dfa2.run();
 
         for (int i = 0; i < NODES_NUM; ++i) {
-            check(d->getNode(i)->counter == 2,
-                  "did not go through the node only one time but %d",
-                  d->getNode(i)->counter);
+            TestNode *n = d->getNode(i);
+            int expected = n->getBBlock() == d->getEntryBB() ? 2 : 1;
+            check(n->counter == expected,
+                  "did not go through the node %d times but %d",
+                  expected, n->counter);
         }
 
         const analysis::DataFlowStatistics& stats2 = dfa2.getStatistics();
         check(stats2.getBBlocksNum() == NODES_NUM, "wrong number of blocks: %d",
               stats2.getBBlocksNum());
-        check(stats2.processedBlocks == 2*NODES_NUM,
-              "processed more blocks than %d - %d", 2*NODES_NUM, stats2.processedBlocks);
+        check(stats2.processedBlocks == NODES_NUM + 1,
+              "processed more blocks than %d - %d", NODES_NUM + 1, stats2.processedBlocks);
+        check(stats2.getSkippedBlocksNum() == NODES_NUM - 1,
+              "skipped wrong number of blocks: %d", stats2.getSkippedBlocksNum());
         check(stats2.getIterationsNum() == 2, "did wrong number of iterations: %d",
               stats2.getIterationsNum());
 
         #undef NODES_NUM
     }
 
+    // on acyclic graph every block goes after its predecessors,
+    // so every block is processed only once even when it changes
+    void run_rpo_test()
+    {
+        #define NODES_NUM 6
+        TestDG *d = new TestDG();
+        TestNode *nodes[NODES_NUM];
+        for (int i = 0; i < NODES_NUM; ++i) {
+            nodes[i] = new TestNode(i);
+            d->addNode(nodes[i]);
+            new TestBBlock(nodes[i]);
+        }
+
+        // 0 -> 1 -> 2 -> 5, 0 -> 3 -> 2, 3 -> 4 -> 5
+        static const int edges[][2] = {{0, 1}, {1, 2}, {2, 5},
+                                       {0, 3}, {3, 2}, {3, 4}, {4, 5}};
+        for (auto& e : edges)
+            nodes[e[0]]->getBBlock()->addSuccessor(nodes[e[1]]->getBBlock());
+
+        d->setEntryBB(nodes[0]->getBBlock());
+        d->setEntry(nodes[0]);
+
+        DataFlowA dfa(d->getEntryBB(), one_change);
+        dfa.run();
+
+        for (int i = 0; i < NODES_NUM; ++i) {
+            check(nodes[i]->counter == 1,
+                  "did not go through the node only one time but %d",
+                  nodes[i]->counter);
+        }
+
+        const analysis::DataFlowStatistics& stats = dfa.getStatistics();
+        check(stats.processedBlocks == NODES_NUM,
+              "processed more blocks than %d - %d", NODES_NUM, stats.processedBlocks);
+        check(stats.getIterationsNum() == 1, "did wrong number of iterations: %d",
+              stats.getIterationsNum());
+
+        #undef NODES_NUM
+    }
+
+    // the change of the exit of a procedure must
+    // get back to the block that calls the procedure
+    void run_return_test()
+    {
+        #define NODES_NUM 4
+        // the caller 0 -> 1, where 0 calls the procedure 2 -> 3
+        TestDG *d = new TestDG();
+        TestDG *sub = new TestDG();
+        TestNode *nodes[NODES_NUM];
+        for (int i = 0; i < NODES_NUM; ++i) {
+            nodes[i] = new TestNode(i);
+            (i < 2 ? d : sub)->addNode(nodes[i]);
+            new TestBBlock(nodes[i]);
+        }
+
+        nodes[0]->getBBlock()->addSuccessor(nodes[1]->getBBlock());
+        nodes[2]->getBBlock()->addSuccessor(nodes[3]->getBBlock());
+
+        d->setEntryBB(nodes[0]->getBBlock());
+        d->setEntry(nodes[0]);
+        sub->setEntryBB(nodes[2]->getBBlock());
+        sub->setEntry(nodes[2]);
+        sub->setExitBB(nodes[3]->getBBlock());
+
+        nodes[0]->addSubgraph(sub);
+        nodes[0]->getBBlock()->addCallsite(nodes[0]);
+
+        DataFlowA dfa(d->getEntryBB(), one_change,
+                      analysis::DATAFLOW_INTERPROCEDURAL);
+        dfa.run();
+
+        for (int i = 0; i < NODES_NUM; ++i) {
+            int expected = i == 0 ? 2 : 1;
+            check(nodes[i]->counter == expected,
+                  "did not go through the node %d times but %d",
+                  expected, nodes[i]->counter);
+        }
+
+        const analysis::DataFlowStatistics& stats = dfa.getStatistics();
+        check(stats.processedBlocks == NODES_NUM + 1,
+              "processed more blocks than %d - %d", NODES_NUM + 1, stats.processedBlocks);
+        check(stats.getIterationsNum() == 2, "did wrong number of iterations: %d",
+              stats.getIterationsNum());
+
+        // nothing changes now, the statistics are only of this run
+        dfa.run();
+        check(stats.processedBlocks == NODES_NUM,
+              "processed more blocks than %d - %d", NODES_NUM, stats.processedBlocks);
+        check(stats.getSkippedBlocksNum() == 0,
+              "skipped wrong number of blocks: %d", stats.getSkippedBlocksNum());
+        check(stats.getIterationsNum() == 1, "did wrong number of iterations: %d",
+              stats.getIterationsNum());
+
+        #undef NODES_NUM
+    }
+
     void run_nums_test_interproc()
     {
         #define NODES_NUM 5
@@ -206,8 +310,10 @@ public:
 
         for (int i = 0; i < NODES_NUM; ++i) {
             TestNode *n = d->getNode(i);
-            check(n->counter == 2,
-                  "did not go through the node only one time but %d", n->counter);
+            int expected = n->getBBlock() == d->getEntryBB() ? 2 : 1;
+            check(n->counter == expected,
+                  "did not go through the node %d times but %d",
+                  expected, n->counter);
 
             // check that subgraphs are untouched by the dataflow
             // analysis
@@ -215,7 +321,8 @@ public:
                 // iterate over nodes
                 for (auto It : *sub) {
                     TestNode *n = It.second;
-                    check(n->counter == 2,
+                    int expected = n->getBBlock() == sub->getEntryBB() ? 2 : 1;
+                    check(n->counter == expected,
                           "intErproc. dataflow did NOT went to procedures (%d - %d)",
                           n->getKey(), n->counter);
 
@@ -237,11 +344,13 @@ public:
         // same size + the blocks in parent graph
         // we don't go through the parameters!
         uint64_t blocks_num = (NODES_NUM + 1) * NODES_NUM;
+        // the entry blocks of all the graphs are processed twice
+        uint64_t processed_num = blocks_num + NODES_NUM + 1;
         const analysis::DataFlowStatistics& stats2 = dfa2.getStatistics();
         check(stats2.getBBlocksNum() == blocks_num, "wrong number of blocks: %d",
               stats2.getBBlocksNum());
-        check(stats2.processedBlocks == 2*blocks_num,
-              "processed more blocks than %d - %d", 2*blocks_num, stats2.processedBlocks);
+        check(stats2.processedBlocks == processed_num,
+              "processed more blocks than %d - %d", processed_num, stats2.processedBlocks);
         check(stats2.getIterationsNum() == 2, "did wrong number of iterations: %d",
               stats2.getIterationsNum());
 
@@ -253,8 +362,10 @@ public:
 
         for (int i = 0; i < NODES_NUM; ++i) {
             TestNode *n = d->getNode(i);
-            check(n->counter == 2,
-                  "did not go through the node only one time but %d", n->counter);
+            int expected = n->getBBlock() == d->getEntryBB() ? 2 : 1;
+            check(n->counter == expected,
+                  "did not go through the node %d times but %d",
+                  expected, n->counter);
 
             // check that subgraphs are untouched by the dataflow
             // analysis
@@ -262,7 +373,8 @@ public:
                 // iterate over nodes
                 for (auto It : *sub) {
                     TestNode *n = It.second;
-                    check(n->counter == 2,
+                    int expected = n->getBBlock() == sub->getEntryBB() ? 2 : 1;
+                    check(n->counter == expected,
                           "intErproc. dataflow did NOT went to procedures (%d - %d)",
                           n->getKey(), n->counter);
 
@@ -285,8 +397,8 @@ public:
         const analysis::DataFlowStatistics& stats3 = dfa3.getStatistics();
         check(stats3.getBBlocksNum() == blocks_num, "wrong number of blocks: %d",
               stats3.getBBlocksNum());
-        check(stats3.processedBlocks == 2*blocks_num,
-              "processed more blocks than %d - %d", 2*blocks_num, stats3.processedBlocks);
+        check(stats3.processedBlocks == processed_num,
+              "processed more blocks than %d - %d", processed_num, stats3.processedBlocks);
         check(stats3.getIterationsNum() == 2, "did wrong number of iterations: %d",
               stats3.getIterationsNum());
 
@@ -7,6 +7,9 @@
 #include "test-dg.h"
 
 #include "analysis/Slicing.h"
+#ifdef ENABLE_CFG
+#include "analysis/PostDominators.h"
+#endif
 #include "DG2Dot.h"
 
 namespace dg {
@@ -141,7 +144,7 @@ public:
 
     void test()
     {
-#if ENABLE_CFG
+#ifdef ENABLE_CFG
         TestNode n1(1);
         TestNode n2(2);
 
@@ -166,6 +169,73 @@ public:
 };
 
 
+class TestFreeze : public Test
+{
+public:
+    TestFreeze() : Test("frozen edges test")
+    {}
+
+    void test()
+    {
+        TestDG d;
+        TestNode n1(1);
+        TestNode n2(2);
+        TestNode n3(3);
+        // not in the graph, but connected to it
+        TestNode n4(4);
+
+        d.addNode(&n1);
+        d.addNode(&n2);
+        d.addNode(&n3);
+
+        n1.addControlDependence(&n2);
+        n1.addControlDependence(&n3);
+        n2.addDataDependence(&n3);
+        n3.addDataDependence(&n1);
+        n4.addDataDependence(&n1);
+
+        d.freeze();
+        check(d.isFrozen(), "graph is not frozen");
+        check(n1.isFrozen() && n2.isFrozen() && n3.isFrozen(),
+              "nodes of the graph are not frozen");
+        check(n4.isFrozen(), "connected node is not frozen");
+        check(d.getFrozenEdges()->nodesNum() == 4,
+              "wrong number of frozen nodes: %u", d.getFrozenEdges()->nodesNum());
+        check(d.getFrozenEdges()->edgesNum() == 10,
+              "wrong number of frozen edges: %u", d.getFrozenEdges()->edgesNum());
+
+        check(n1.getControlDependenciesNum() == 2, "lost CD edges");
+        check(n3.getRevControlDependenciesNum() == 1, "lost rev. CD edges");
+        check(n1.getRevDataDependenciesNum() == 2, "lost rev. DD edges");
+        check(*n2.data_begin() == &n3, "wrong DD edge");
+        check(*n2.rev_control_begin() == &n1, "wrong rev. CD edge");
+
+        int num = 0;
+        for (auto it = n1.control_begin(), et = n1.control_end(); it != et; ++it) {
+            check(*it == &n2 || *it == &n3, "wrong CD edge");
+            ++num;
+        }
+        check(num == 2, "iterated over %d CD edges", num);
+
+        // modifying the edges must not break them
+        check(!n2.addDataDependence(&n3), "added existing edge");
+        check(!n2.isFrozen() && !n3.isFrozen(), "modified nodes are frozen");
+        check(n3.isFrozen() == false && n1.isFrozen(), "wrong nodes were thawed");
+        check(n2.getDataDependenciesNum() == 1, "lost DD edges");
+        check(n3.getRevDataDependenciesNum() == 1, "lost rev. DD edges");
+
+        check(n3.removeDataDependence(&n1), "did not remove edge");
+        check(n1.getRevDataDependenciesNum() == 1, "did not remove rev. DD edge");
+        check(*n1.rev_data_begin() == &n4, "wrong rev. DD edge");
+
+        n1.removeCDs();
+        check(n1.getControlDependenciesNum() == 0, "did not remove CD edges");
+        check(n2.getRevControlDependenciesNum() == 0, "did not remove rev. CD edge");
+        check(n3.getRevControlDependenciesNum() == 0, "did not remove rev. CD edge");
+        check(n4.isFrozen() && *n4.data_begin() == &n1, "lost edges of frozen node");
+    }
+};
+
 class TestCFG : public Test
 {
 public:
@@ -174,7 +244,7 @@ public:
 
     void test()
     {
-#if ENABLE_CFG
+#ifdef ENABLE_CFG
 
         TestDG d;
         TestNode n1(1);
@@ -241,6 +311,78 @@ public:
     }
 };
 
+class TestPostDominators : public Test
+{
+public:
+    TestPostDominators() : Test("post-dominators test")
+    {}
+
+#ifdef ENABLE_CFG
+    void diamond()
+    {
+        TestBBlock A, B, C, D;
+        A.addSuccessor(&B);
+        A.addSuccessor(&C);
+        B.addSuccessor(&D);
+        C.addSuccessor(&D);
+
+        std::vector<TestBBlock *> blocks{&A, &B, &C, &D};
+        analysis::PostDominators<TestNode> pdoms;
+        TestBBlock *root = pdoms.compute(blocks.begin(), blocks.end(), true);
+
+        check(root, "Did not create the root");
+        check(A.getIPostDom() == &D, "Wrong ipostdom of A");
+        check(B.getIPostDom() == &D, "Wrong ipostdom of B");
+        check(C.getIPostDom() == &D, "Wrong ipostdom of C");
+        check(D.getIPostDom() == root, "Wrong ipostdom of D");
+
+        check(B.getPostDomFrontiers().size() == 1
+              && B.getPostDomFrontiers().contains(&A), "Wrong frontier of B");
+        check(C.getPostDomFrontiers().contains(&A), "Wrong frontier of C");
+        check(A.getPostDomFrontiers().size() == 0, "Wrong frontier of A");
+        check(D.getPostDomFrontiers().size() == 0, "Wrong frontier of D");
+        check(A.controlDependence().size() == 2, "Wrong CD of A");
+        check(!D.hasControlDependence(), "D has CD");
+
+        delete root;
+    }
+
+    void infiniteLoop()
+    {
+        // A -> B -> C -> B is the infinite loop, A -> D is the exit
+        TestBBlock A, B, C, D;
+        A.addSuccessor(&B);
+        A.addSuccessor(&D);
+        B.addSuccessor(&C);
+        C.addSuccessor(&B);
+
+        std::vector<TestBBlock *> blocks{&A, &B, &C, &D};
+        analysis::PostDominators<TestNode> pdoms;
+        TestBBlock *root = pdoms.compute(blocks.begin(), blocks.end(), true);
+
+        // C gets the virtual edge to the exit
+        check(C.getIPostDom() == root, "Wrong ipostdom of C");
+        check(B.getIPostDom() == &C, "Wrong ipostdom of B");
+        check(A.getIPostDom() == root, "Wrong ipostdom of A");
+        check(D.getIPostDom() == root, "Wrong ipostdom of D");
+
+        check(A.controlDependence().contains(&B), "B is not CD on A");
+        check(A.controlDependence().contains(&D), "D is not CD on A");
+        check(C.controlDependence().contains(&B), "B is not CD on C");
+
+        delete root;
+    }
+#endif // ENABLE_CFG
+
+    void test()
+    {
+#ifdef ENABLE_CFG
+        diamond();
+        infiniteLoop();
+#endif // ENABLE_CFG
+    }
+};
+
 class TestRemove : public Test
 {
 public:
@@ -504,13 +646,69 @@ private:
     }
 };
 
+class TestEnterGraph : public Test
+{
+    // remember the graphs that the marking entered
+    class EnterGraphSlicer : public analysis::Slicer<TestNode>
+    {
+    public:
+        std::vector<DependenceGraph<TestNode> *> entered;
+
+        /* virtual */
+        void enterGraph(DependenceGraph<TestNode> *dg)
+        {
+            entered.push_back(dg);
+        }
+    };
+
+public:
+    TestEnterGraph() : Test("entering graphs while slicing test")
+    {}
+
+    void test()
+    {
+        TestDG d1, d2;
+        TestNode e1(1), n1(2), n2(3);
+        TestNode e2(4), n3(5);
+
+        d1.addNode(&e1);
+        d1.addNode(&n1);
+        d1.addNode(&n2);
+        d1.setEntry(&e1);
+        d2.addNode(&e2);
+        d2.addNode(&n3);
+        d2.setEntry(&e2);
+
+        n1.addDataDependence(&n2);
+
+        EnterGraphSlicer slicer;
+        uint32_t sid = slicer.mark(&n2);
+        check(slicer.entered.size() == 1 && slicer.entered[0] == &d1,
+              "should enter only the first graph, entered %u",
+              slicer.entered.size());
+
+        // the same slice, the graph was already entered
+        slicer.mark(&n1, sid);
+        check(slicer.entered.size() == 1, "entered a graph twice");
+
+        // a new slice that goes into the second graph
+        n3.addDataDependence(&n1);
+        slicer.entered.clear();
+        slicer.mark(&n2);
+        check(slicer.entered.size() == 2, "should enter both graphs, "
+                                          "entered %u", slicer.entered.size());
+        check(slicer.entered[0] == &d1 && slicer.entered[1] == &d2,
+              "entered wrong graphs");
+    }
+};
+
 class TestSlicingCFG : public Test
 {
 public:
     TestSlicingCFG() : Test("Slicing BBlocks test")
     {}
 
-#if ENABLE_CFG
+#ifdef ENABLE_CFG
     void test1()
     {
 
@@ -686,9 +884,12 @@ int main(void)
     TestRunner Runner;
 
     Runner.add(new TestCFG());
+    Runner.add(new TestPostDominators());
     Runner.add(new TestContainer());
     Runner.add(new TestAdd());
     Runner.add(new TestRemove());
+    Runner.add(new TestFreeze());
+    Runner.add(new TestEnterGraph());
     Runner.add(new TestSlicingCFG());
 
     return Runner();
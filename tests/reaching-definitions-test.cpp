@@ -7,7 +7,16 @@
 #include "test-dg.h"
 
 #include "analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/BlockReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/DemandReachingDefinitions.h"
+#include "analysis/ReachingDefinitions/BitvectorReachingDefinitions.h"
 #include "analysis/ReachingDefinitions/RDMap.h"
+#include "analysis/ReachingDefinitions/SemisparseRda.h"
+#include "analysis/ReachingDefinitions/Srg/IntervalMap.h"
+#include "analysis/ReachingDefinitions/Srg/PhiPlacement.h"
+#include "analysis/ReachingDefinitions/Srg/MarkerSRGBuilderFS.h"
+#include "analysis/DominanceFrontiers.h"
+#include "ADT/Parallel.h"
 
 namespace dg {
 namespace tests {
@@ -237,12 +246,802 @@ public:
         //dumpMap(&S2);
     }
 
+    // AL1 -> S1 -> B -> S2 -> J -> S3 -> E
+    //              |         ^           |
+    //              +---------+ <---------+ (E -> B)
+    static void buildLoop(RDNode *nodes)
+    {
+        RDNode *AL1 = &nodes[0];
+        nodes[1].addDef(AL1, 0, 4, true /* strong update */);
+        nodes[3].addDef(AL1, 0, 4, true /* strong update */);
+        nodes[5].addDef(AL1, 0, 2, true /* strong update */);
+
+        nodes[0].addSuccessor(&nodes[1]);
+        nodes[1].addSuccessor(&nodes[2]);
+        nodes[2].addSuccessor(&nodes[3]);
+        nodes[2].addSuccessor(&nodes[4]);
+        nodes[3].addSuccessor(&nodes[4]);
+        nodes[4].addSuccessor(&nodes[5]);
+        nodes[5].addSuccessor(&nodes[6]);
+        nodes[6].addSuccessor(&nodes[2]);
+    }
+
+    // two copies of the graph from buildLoop(), the first one
+    // analysed by RDA and the other one by RefRDA
+    template <typename RDA, typename RefRDA = ReachingDefinitionsAnalysis>
+    struct LoopGraphs {
+        RDNode nodes[7];
+        RDNode ref_nodes[7];
+        RDA RD;
+        RefRDA RefRD;
+
+        // @size is the size of the allocated memory (0 is unknown)
+        LoopGraphs(size_t size = 0)
+        : RD(&nodes[0]), RefRD(&ref_nodes[0])
+        {
+            buildLoop(nodes);
+            buildLoop(ref_nodes);
+            nodes[0].setSize(size);
+            ref_nodes[0].setSize(size);
+
+            RD.run();
+            RefRD.run();
+        }
+    };
+
+    void blocks1()
+    {
+        LoopGraphs<BlockReachingDefinitionsAnalysis> G;
+
+        RDNode *AL1 = &G.nodes[0];
+        RDNode *S1 = &G.nodes[1];
+        RDNode *S2 = &G.nodes[3];
+        RDNode *J = &G.nodes[4];
+        RDNode *S3 = &G.nodes[5];
+
+        // AL1 S1 | B | S2 | J S3 E
+        check(G.RD.getBlocks().size() == 4, "Should have 4 blocks");
+
+        std::set<RDNode *> rd;
+        S3->getReachingDefinitions(AL1, 0, 1, rd);
+        check(rd.size() == 3, "Should be S1, S2 and S3");
+        rd.clear();
+        S3->getReachingDefinitions(AL1, 2, 1, rd);
+        check(rd.size() == 2 && !rd.count(S3), "Should be S1 and S2");
+        rd.clear();
+        J->getReachingDefinitions(AL1, 0, 1, rd);
+        check(rd.size() == 3, "Should be S1, S2 and S3");
+        rd.clear();
+        S2->getReachingDefinitions(AL1, 0, 1, rd);
+        check(rd.size() == 1 && *rd.begin() == S2, "Should be S2");
+        rd.clear();
+        S1->getReachingDefinitions(AL1, 4, 1, rd);
+        check(rd.empty(), "Should not have r.d.");
+
+        // the dense analysis must give the same results
+        checkSameResults(G.nodes, G.ref_nodes);
+    }
+
+    // the threads must not mix up the cached definitions of their
+    // queries. Query the analysis RDA from more threads and compare
+    // the results with the serial queries to another copy of the graph
+    template <typename RDA>
+    void checkParallelQueries(size_t size = 0)
+    {
+        LoopGraphs<RDA, RDA> G(size);
+
+        // query the nodes in different orders from more threads
+        auto getNode = [](size_t i) -> unsigned {
+            return i % 2 ? 6 - (i / 5) % 7 : (i / 5) % 7;
+        };
+
+        std::vector<std::set<RDNode *>> results(7 * 5 * 8);
+        ADT::parallelFor(results.size(), 4, [&](size_t i) {
+            G.nodes[getNode(i)].getReachingDefinitions(&G.nodes[0], i % 5, 1,
+                                                       results[i]);
+        });
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::set<RDNode *> rd;
+            G.ref_nodes[getNode(i)].getReachingDefinitions(&G.ref_nodes[0],
+                                                           i % 5, 1, rd);
+            check(results[i].size() == rd.size(), "The threads got wrong results");
+            for (RDNode *n : rd)
+                check(results[i].count(&G.nodes[n - G.ref_nodes]),
+                      "The threads got wrong results");
+        }
+    }
+
+    void blocks2()
+    {
+        checkParallelQueries<BlockReachingDefinitionsAnalysis>();
+    }
+
+    // check that two copies of the graph from buildLoop()
+    // have the same reaching definitions
+    void checkSameResults(RDNode *nodes, RDNode *nodes2)
+    {
+        for (unsigned i = 0; i < 7; ++i) {
+            for (unsigned off = 0; off < 5; ++off) {
+                std::set<RDNode *> rd, rd2;
+                nodes[i].getReachingDefinitions(&nodes[0], off, 1, rd);
+                nodes2[i].getReachingDefinitions(&nodes2[0], off, 1, rd2);
+
+                check(rd.size() == rd2.size(), "The analyses differ");
+                for (RDNode *n : rd2)
+                    check(rd.count(&nodes[n - nodes2]), "The analyses differ");
+            }
+        }
+    }
+
+    // check that the maps of the nodes from two copies of the graph
+    // from buildLoop() are the same
+    void checkSameMaps(RDNode *nodes, RDNode *nodes2)
+    {
+        for (unsigned i = 0; i < 7; ++i) {
+            RDMap map, map2;
+            nodes[i].getReachingDefinitions(map);
+            nodes2[i].getReachingDefinitions(map2);
+
+            check(map.size() == map2.size(), "The maps differ");
+            for (const auto& it : map2) {
+                DefSite ds(&nodes[it.first.target - nodes2],
+                           it.first.offset, it.first.len);
+                const RDNodesSet& defs = map.get(ds);
+                check(defs.size() == it.second.size(), "The maps differ");
+                for (RDNode *n : it.second)
+                    check(defs.count(&nodes[n - nodes2]), "The maps differ");
+            }
+        }
+    }
+
+    void maps1()
+    {
+        // the block analyses do not keep the definitions in def_map
+        LoopGraphs<BlockReachingDefinitionsAnalysis> G;
+        LoopGraphs<DemandReachingDefinitionsAnalysis> DemG;
+
+        checkSameMaps(G.nodes, G.ref_nodes);
+        checkSameMaps(DemG.nodes, DemG.ref_nodes);
+
+        RDMap map;
+        G.nodes[5].getReachingDefinitions(map);
+        check(map.get(DefSite(&G.nodes[0], 0, 2)).count(&G.nodes[5]),
+              "Should be S3");
+    }
+
+    void demand1()
+    {
+        LoopGraphs<DemandReachingDefinitionsAnalysis> G;
+
+        RDNode *AL1 = &G.nodes[0];
+        RDNode *S1 = &G.nodes[1];
+        RDNode *S2 = &G.nodes[3];
+        RDNode *J = &G.nodes[4];
+        RDNode *S3 = &G.nodes[5];
+
+        std::set<RDNode *> rd;
+        G.RD.getReachingDefinitions(S3, DefSite(AL1, 0, 1), rd);
+        check(rd.size() == 3, "Should be S1, S2 and S3");
+        rd.clear();
+        G.RD.getReachingDefinitions(J, DefSite(AL1, 2, 1), rd);
+        check(rd.size() == 2 && rd.count(S1) && rd.count(S2),
+              "Should be S1 and S2");
+        rd.clear();
+        G.RD.getReachingDefinitions(S1, DefSite(AL1, 4, 1), rd);
+        check(rd.empty(), "Should not have r.d.");
+
+        // the dense analysis must give the same results
+        checkSameResults(G.nodes, G.ref_nodes);
+    }
+
+    void demand2()
+    {
+        checkParallelQueries<DemandReachingDefinitionsAnalysis>();
+    }
+
+    void worklist1()
+    {
+        LoopGraphs<ReachingDefinitionsAnalysis,
+                   RoundsReachingDefinitionsAnalysis> G;
+
+        checkSameResults(G.nodes, G.ref_nodes);
+
+        const auto& st = G.RD.getStatistics();
+        const auto& rst = G.RefRD.getStatistics();
+        check(st.getProcessedNodes() <= rst.getProcessedNodes(),
+              "Worklist processed more nodes than rounds");
+        check(st.getMergesNum() < rst.getMergesNum(),
+              "Worklist should merge less maps");
+        check(st.getSkippedMergesNum() > 0, "Worklist should skip merges");
+    }
+
+    void bitvector1()
+    {
+        RDNode AL1, AL2;
+        RDNode S1, S2, B, S3, J, S4, E;
+
+        AL1.setSize(4);
+        AL2.setSize(8);
+        S1.addDef(&AL1, 0, 4, true /* strong update */);
+        S2.addDef(&AL2, 0, 4, true /* strong update */);
+        S3.addDef(&AL1, 0, 4, true /* strong update */);
+        S4.addDef(&AL2, 4, 4, true /* strong update */);
+
+        AL1.addSuccessor(&AL2);
+        AL2.addSuccessor(&S1);
+        S1.addSuccessor(&S2);
+        S2.addSuccessor(&B);
+        B.addSuccessor(&S3);
+        B.addSuccessor(&J);
+        S3.addSuccessor(&J);
+        J.addSuccessor(&S4);
+        S4.addSuccessor(&E);
+
+        BVReachingDefinitionsAnalysis RD(&AL1);
+        RD.run();
+
+        check(RD.getDefinitionsNum() == 4, "Should have 4 definitions");
+
+        std::set<RDNode *> rd;
+        E.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 2 && rd.count(&S1) && rd.count(&S3),
+              "Should be S1 and S3");
+        rd.clear();
+        S3.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 1 && rd.count(&S3), "Should be S3");
+        rd.clear();
+        J.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 2, "Should be S1 and S3");
+        rd.clear();
+        B.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 1 && rd.count(&S1), "Should be S1");
+
+        // S4 does not overwrite the whole AL2
+        rd.clear();
+        E.getReachingDefinitions(&AL2, 0, 1, rd);
+        check(rd.size() == 2 && rd.count(&S2) && rd.count(&S4),
+              "Should be S2 and S4");
+        rd.clear();
+        S1.getReachingDefinitions(&AL2, 0, 1, rd);
+        check(rd.empty(), "Should not have r.d.");
+
+        // the definitions are of the whole objects
+        RDMap map;
+        E.getReachingDefinitions(map);
+        check(map.size() == 2, "Should have AL1 and AL2");
+        const RDNodesSet& defs = map.get(DefSite(&AL1));
+        check(defs.size() == 2 && defs.count(&S1) && defs.count(&S3),
+              "Should be S1 and S3");
+    }
+
+    void bitvector2()
+    {
+        checkParallelQueries<BVReachingDefinitionsAnalysis>(4);
+    }
+
+    using BlockT = BBlock<RDNode>;
+    using BlocksT = std::vector<std::unique_ptr<BlockT>>;
+
+    // put the nodes into blocks for the semi-sparse analysis,
+    // @starts are the indices of the first nodes of the blocks
+    // and @edges are the edges between the blocks. The nodes
+    // are connected also by successor edges for the dense analysis.
+    static void buildBlocks(RDNode *nodes, unsigned nodes_num,
+                            const std::vector<unsigned>& starts,
+                            const std::vector<std::pair<unsigned, unsigned>>& edges,
+                            BlocksT& blocks)
+    {
+        for (unsigned b = 0; b < starts.size(); ++b) {
+            unsigned end = b + 1 < starts.size() ? starts[b + 1] : nodes_num;
+            blocks.emplace_back(new BlockT());
+            for (unsigned i = starts[b]; i < end; ++i) {
+                blocks[b]->append(&nodes[i]);
+                if (i + 1 < end)
+                    nodes[i].addSuccessor(&nodes[i + 1]);
+            }
+        }
+
+        for (const auto& edge : edges) {
+            blocks[edge.first]->addSuccessor(blocks[edge.second].get());
+            blocks[edge.first]->getLastNode()->addSuccessor(
+                                    blocks[edge.second]->getFirstNode());
+        }
+    }
+
+    // check that the nodes get the same definitions for their uses
+    void checkSameUses(RDNode *nodes, RDNode *nodes2, unsigned nodes_num)
+    {
+        for (unsigned i = 0; i < nodes_num; ++i) {
+            for (const DefSite& use : nodes2[i].getUses()) {
+                std::set<RDNode *> rd, rd2;
+                RDNode *target = use.target->isUnknown() ?
+                                    UNKNOWN_MEMORY : &nodes[use.target - nodes2];
+                nodes[i].getReachingDefinitions(target, use.offset, use.len, rd);
+                nodes2[i].getReachingDefinitions(use.target, use.offset,
+                                                 use.len, rd2);
+
+                check(rd.size() == rd2.size(), "The analyses differ");
+                for (RDNode *n : rd2)
+                    check(rd.count(&nodes[n - nodes2]), "The analyses differ");
+            }
+        }
+    }
+
+    // B0 -> B1 -> B3 -> B4
+    //  |          ^
+    //  +--> B2 ---+
+    static void buildDiamond(RDNode *nodes, BlocksT& blocks)
+    {
+        RDNode *A1 = &nodes[0];
+        RDNode *A2 = &nodes[1];
+        nodes[2].addDef(A1, 0, 4, true /* strong update */);
+        nodes[3].addDef(A2, 0, 4, true /* strong update */);
+        nodes[4].addDef(A2, 0, 4, true /* strong update */);
+        nodes[5].addDef(A1, 0, 4, true /* strong update */);
+        // B3: a node that reads and weakly updates both variables,
+        // so its def map has sub-maps of more targets
+        nodes[6].addUse(A1, 0, 4);
+        nodes[6].addUse(A2, 0, 4);
+        nodes[6].addDef(A1);
+        nodes[6].addDef(A2);
+        // B4: read the variables again
+        nodes[7].addUse(A1, 0, 4);
+        nodes[8].addUse(A2, 0, 4);
+
+        buildBlocks(nodes, 9, {0, 4, 5, 6, 7},
+                    {{0, 1}, {0, 2}, {1, 3}, {2, 3}, {3, 4}}, blocks);
+    }
+
+    void semisparse1()
+    {
+        RDNode nodes[9];
+        RDNode dense_nodes[9];
+        BlocksT blocks, dense_blocks;
+        buildDiamond(nodes, blocks);
+        buildDiamond(dense_nodes, dense_blocks);
+
+        SemisparseRda RD(&nodes[0]);
+        RD.run();
+        ReachingDefinitionsAnalysis DRD(&dense_nodes[0]);
+        DRD.run();
+
+        checkSameUses(nodes, dense_nodes, 9);
+
+        // the definitions of the other variable
+        // must not leak from the def map of nodes[6]
+        std::set<RDNode *> rd;
+        nodes[7].getReachingDefinitions(&nodes[0], 0, 4, rd);
+        check(rd.size() == 3 && rd.count(&nodes[2]) && rd.count(&nodes[5])
+              && rd.count(&nodes[6]), "Should be S1, S4 and X");
+        rd.clear();
+        nodes[8].getReachingDefinitions(&nodes[1], 0, 4, rd);
+        check(rd.size() == 3 && rd.count(&nodes[3]) && rd.count(&nodes[4])
+              && rd.count(&nodes[6]), "Should be S2, S3 and X");
+        check(!nodes[7].def_map.definesWithAnyOffset(DefSite(&nodes[1])),
+              "Should not have definitions of A2");
+    }
+
+    // B0 -> B1 -> B3
+    //  |          ^
+    //  +--> B2 ---+
+    //
+    // B0: A1, S1 = store A1
+    // B1: S2 = store A1 or store to unknown memory
+    // B2: N
+    // B3: L = load A1 or load from unknown memory
+    static void buildUnknownDiamond(RDNode *nodes, BlocksT& blocks,
+                                    bool unknown_store)
+    {
+        RDNode *A1 = &nodes[0];
+        nodes[1].addDef(A1, 0, 4, true /* strong update */);
+        if (unknown_store) {
+            nodes[2].addDef(UNKNOWN_MEMORY);
+            nodes[4].addUse(A1, 0, 4);
+        } else {
+            nodes[2].addDef(A1, 0, 4, true /* strong update */);
+            nodes[4].addUse(UNKNOWN_MEMORY);
+        }
+
+        buildBlocks(nodes, 5, {0, 2, 3, 4},
+                    {{0, 1}, {0, 2}, {1, 3}, {2, 3}}, blocks);
+    }
+
+    // store via unknown pointer followed by a concrete load
+    void semisparse_unknown1()
+    {
+        RDNode nodes[5];
+        RDNode dense_nodes[5];
+        BlocksT blocks, dense_blocks;
+        buildUnknownDiamond(nodes, blocks, true);
+        buildUnknownDiamond(dense_nodes, dense_blocks, true);
+
+        SemisparseRda RD(&nodes[0]);
+        RD.run();
+        ReachingDefinitionsAnalysis DRD(&dense_nodes[0]);
+        DRD.run();
+
+        checkSameUses(nodes, dense_nodes, 5);
+
+        // the definitions of unknown memory are kept
+        // under UNKNOWN_MEMORY, not under the concrete memory
+        std::set<RDNode *> rd;
+        nodes[4].getReachingDefinitions(&nodes[0], 0, 4, rd);
+        check(rd.size() == 1 && rd.count(&nodes[1]), "Should be S1");
+        rd.clear();
+        nodes[4].getReachingDefinitions(UNKNOWN_MEMORY, analysis::Offset::UNKNOWN,
+                                        analysis::Offset::UNKNOWN, rd);
+        check(rd.size() == 1 && rd.count(&nodes[2]), "Should be S2");
+    }
+
+    // concrete store followed by a load via unknown pointer
+    void semisparse_unknown2()
+    {
+        RDNode nodes[5];
+        RDNode dense_nodes[5];
+        BlocksT blocks, dense_blocks;
+        buildUnknownDiamond(nodes, blocks, false);
+        buildUnknownDiamond(dense_nodes, dense_blocks, false);
+
+        SemisparseRda RD(&nodes[0]);
+        RD.run();
+        ReachingDefinitionsAnalysis DRD(&dense_nodes[0]);
+        DRD.run();
+
+        // the load may read any memory,
+        // so it must get the definitions of A1
+        std::set<RDNode *> rd, dense_rd;
+        nodes[4].getReachingDefinitions(&nodes[0], 0, 4, rd);
+        check(rd.size() == 2 && rd.count(&nodes[1]) && rd.count(&nodes[2]),
+              "Should be S1 and S2");
+        dense_nodes[4].getReachingDefinitions(&dense_nodes[0], 0, 4, dense_rd);
+        check(dense_rd.size() == 2, "Should be S1 and S2");
+
+        rd.clear();
+        nodes[4].getReachingDefinitions(UNKNOWN_MEMORY, analysis::Offset::UNKNOWN,
+                                        analysis::Offset::UNKNOWN, rd);
+        check(rd.empty(), "Should not have definitions of unknown memory");
+    }
+
+    // a random program of blocks with calls of functions
+    struct RandomProgram {
+        std::vector<std::unique_ptr<RDNode>> nodes;
+        std::unordered_map<RDNode *, unsigned> ids;
+        BlocksT blocks;
+        RDNode vars[2];
+
+        RDNode *createNode(RDNodeType type = RDNodeType::NONE)
+        {
+            nodes.emplace_back(new RDNode(type));
+            ids[nodes.back().get()] = nodes.size() - 1;
+            return nodes.back().get();
+        }
+
+        BlockT *createBlock()
+        {
+            blocks.emplace_back(new BlockT());
+            // a node that defines or uses the variables at random
+            RDNode *n = createNode();
+            RDNode *var = &vars[rand() % 2];
+            if (rand() % 2)
+                n->addDef(var, 4 * (rand() % 2), 4, rand() % 2);
+            if (rand() % 2)
+                n->addUse(var, 4 * (rand() % 2), 4);
+            blocks.back()->append(n);
+            return blocks.back().get();
+        }
+
+        // the functions are called only by the functions
+        // with a smaller number, the function 0 is the entry
+        RandomProgram(unsigned seed)
+        {
+            srand(seed);
+            const unsigned functions_num = 1 + rand() % 3;
+            std::vector<std::vector<BlockT *>> functions(functions_num);
+            for (auto& F : functions) {
+                for (unsigned i = 2 + rand() % 5; i > 0; --i)
+                    F.push_back(createBlock());
+            }
+
+            // the function must exist when we call it
+            for (unsigned f = functions_num; f > 0; --f) {
+                std::vector<BlockT *>& F = functions[f - 1];
+                auto addEdge = [&](BlockT *from, BlockT *to) {
+                    if (f == functions_num || rand() % 3) {
+                        from->addSuccessor(to);
+                        return;
+                    }
+
+                    // call a function on the edge
+                    std::vector<BlockT *>& G
+                        = functions[f + rand() % (functions_num - f)];
+                    BlockT *call = createBlock();
+                    call->append(createNode(RDNodeType::CALL));
+                    BlockT *ret = new BlockT(createNode(RDNodeType::CALL_RETURN));
+                    blocks.emplace_back(ret);
+
+                    from->addSuccessor(call);
+                    call->addSuccessor(G.front());
+                    G.back()->addSuccessor(ret);
+                    ret->addSuccessor(to);
+                };
+
+                for (unsigned i = 1; i < F.size(); ++i)
+                    addEdge(F[rand() % i], F[i]);
+                for (unsigned e = rand() % F.size(); e > 0; --e)
+                    addEdge(F[rand() % F.size()], F[1 + rand() % (F.size() - 1)]);
+            }
+        }
+    };
+
+    // the numbers of the blocks of the phi nodes
+    static std::multiset<unsigned>
+    getPhiBlocks(const RandomProgram& P,
+                 const std::vector<std::unique_ptr<RDNode>>& phis)
+    {
+        std::multiset<unsigned> ret;
+        for (auto& phi : phis) {
+            for (unsigned i = 0; i < P.blocks.size(); ++i) {
+                if (P.blocks[i].get() == phi->getBBlock())
+                    ret.insert(i);
+            }
+        }
+
+        return ret;
+    }
+
+    static size_t getEdgesNum(const srg::SparseRDGraph& graph)
+    {
+        size_t num = 0;
+        for (auto& it : graph)
+            num += it.second.size();
+        return num;
+    }
+
+    // the graph must not depend on the number of threads
+    void semisparse_threads1()
+    {
+        for (unsigned seed = 0; seed < 200; ++seed) {
+            RandomProgram P(seed), P4(seed);
+            // the first block of the function 0
+            RDNode *root = P.nodes[0].get();
+            RDNode *root4 = P4.nodes[0].get();
+
+            srg::MarkerSRGBuilderFS builder(1), builder4(4);
+            auto graph = builder.build(root);
+            auto graph4 = builder4.build(root4);
+            check(getPhiBlocks(P, graph.second) == getPhiBlocks(P4, graph4.second),
+                  "The phi nodes differ (seed %u)", seed);
+            check(getEdgesNum(graph.first) == getEdgesNum(graph4.first),
+                  "The numbers of edges differ (seed %u)", seed);
+
+            SemisparseRda RD(root, 1);
+            RD.run();
+            SemisparseRda RD4(root4, 4);
+            RD4.run();
+
+            for (unsigned i = 0; i < P.nodes.size(); ++i) {
+                for (const DefSite& use : P.nodes[i]->getUses()) {
+                    std::set<RDNode *> rd, rd4;
+                    P.nodes[i]->getReachingDefinitions(use.target, use.offset,
+                                                       use.len, rd);
+                    P4.nodes[i]->getReachingDefinitions(&P4.vars[use.target - P.vars],
+                                                        use.offset, use.len, rd4);
+
+                    std::set<unsigned> ids, ids4;
+                    for (RDNode *n : rd)
+                        ids.insert(P.ids[n]);
+                    for (RDNode *n : rd4)
+                        ids4.insert(P4.ids[n]);
+                    check(ids == ids4, "The analyses differ (seed %u)", seed);
+                }
+            }
+        }
+    }
+
+    // set the immediate dominators of the blocks,
+    // the blocks[0] is the entry
+    static void computeDominators(BlocksT& blocks)
+    {
+        std::unordered_map<BlockT *, unsigned> ids;
+        for (unsigned i = 0; i < blocks.size(); ++i)
+            ids[blocks[i].get()] = i;
+
+        std::set<unsigned> all;
+        for (unsigned i = 0; i < blocks.size(); ++i)
+            all.insert(i);
+
+        std::vector<std::set<unsigned>> dom(blocks.size(), all);
+        dom[0] = {0};
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (unsigned i = 1; i < blocks.size(); ++i) {
+                std::set<unsigned> cur = all;
+                for (BlockT *pred : blocks[i]->predecessors()) {
+                    std::set<unsigned> tmp;
+                    for (unsigned d : dom[ids[pred]])
+                        if (cur.count(d))
+                            tmp.insert(d);
+                    cur.swap(tmp);
+                }
+
+                cur.insert(i);
+                if (cur != dom[i]) {
+                    dom[i].swap(cur);
+                    changed = true;
+                }
+            }
+        }
+
+        // the immediate dominator is the strict dominator
+        // that is dominated by all the other strict dominators
+        for (unsigned i = 1; i < blocks.size(); ++i) {
+            unsigned idom = 0;
+            for (unsigned d : dom[i]) {
+                if (d != i && dom[d].size() > dom[idom].size())
+                    idom = d;
+            }
+
+            blocks[i]->setIDom(blocks[idom].get());
+        }
+    }
+
+    // the phi placement by the iterated dominance frontiers computed
+    // from the dominance frontiers, as it was done before the linear
+    // time algorithm
+    static srg::PhiAdditions placePhisByDFPlus(const srg::AssignmentMap& am)
+    {
+        srg::PhiAdditions result;
+        for (auto& def : am) {
+            std::set<BlockT *> dfp;
+            std::vector<RDNode *> w = def.second;
+            std::set<RDNode *> work(w.begin(), w.end());
+
+            while (!w.empty()) {
+                BlockT *X = w.back()->getBBlock();
+                w.pop_back();
+
+                for (BlockT *Y : X->getDomFrontiers()) {
+                    if (!dfp.insert(Y).second)
+                        continue;
+
+                    for (RDNode *N : Y->getNodes()) {
+                        for (const DefSite& cds : N->getDefines())
+                            if (cds.target == def.first)
+                                result[Y].insert(cds);
+                        for (const DefSite& cds : N->getUses())
+                            if (cds.target == def.first)
+                                result[Y].insert(cds);
+                    }
+
+                    if (work.insert(Y->getFirstNode()).second)
+                        w.push_back(Y->getFirstNode());
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // compare the phi placement with the old algorithm on random CFGs
+    void phi_placement1()
+    {
+        srand(13);
+        for (unsigned round = 0; round < 300; ++round) {
+            const unsigned blocks_num = 2 + rand() % 14;
+            RDNode vars[3];
+            std::vector<RDNode> nodes(2 * blocks_num);
+            BlocksT blocks;
+
+            // every block has two nodes that define
+            // and use the variables at random
+            for (unsigned i = 0; i < blocks_num; ++i) {
+                blocks.emplace_back(new BlockT());
+                for (unsigned j = 0; j < 2; ++j) {
+                    RDNode *n = &nodes[2 * i + j];
+                    blocks[i]->append(n);
+                    RDNode *var = &vars[rand() % 3];
+                    if (rand() % 3 == 0)
+                        n->addDef(var, 4 * (rand() % 2), 4, true /* strong update */);
+                    if (rand() % 2 == 0)
+                        n->addUse(var, 4 * (rand() % 2), 4);
+                }
+            }
+
+            // every block is reachable from the entry,
+            // nothing goes back to the entry
+            for (unsigned i = 1; i < blocks_num; ++i)
+                blocks[rand() % i]->addSuccessor(blocks[i].get());
+            for (unsigned e = rand() % (2 * blocks_num); e > 0; --e)
+                blocks[rand() % blocks_num]->addSuccessor(
+                                blocks[1 + rand() % (blocks_num - 1)].get());
+
+            computeDominators(blocks);
+            analysis::DominanceFrontiers<RDNode> df;
+            df.compute(blocks[0].get());
+
+            srg::AssignmentMap am;
+            for (RDNode& var : vars) {
+                std::vector<RDNode *>& defs = am[&var];
+                for (RDNode& n : nodes)
+                    if (n.defines(&var))
+                        defs.push_back(&n);
+            }
+
+            srg::PhiAdditions expected = placePhisByDFPlus(am);
+            srg::PhiAdditions result = srg::PhiPlacement().calculate(std::move(am));
+            // DefSite has only operator<
+            bool same = result.size() == expected.size();
+            for (auto& it : expected) {
+                auto rit = result.find(it.first);
+                same &= rit != result.end()
+                        && !(rit->second < it.second)
+                        && !(it.second < rit->second);
+            }
+
+            check(same, "The phi placement differs in round %u", round);
+        }
+    }
+
+    void interval_map1()
+    {
+        using srg::detail::Interval;
+        srg::detail::IntervalMap<int> map;
+        std::vector<int> vals;
+        std::vector<Interval> cov;
+        bool covered;
+
+        map.add(Interval(0, 4), 1);
+        map.add(Interval(4, 4), 2);
+        map.add(Interval(0, 2), 3);
+
+        std::tie(vals, cov, covered) = map.collect(Interval(0, 4), {});
+        check(vals == std::vector<int>({3, 1}), "Should be 3 and 1");
+        check(covered, "Should be covered");
+
+        std::tie(vals, cov, covered) = map.collect(Interval(2, 4), {});
+        check(vals == std::vector<int>({2, 1}), "Should be 2 and 1");
+        check(covered && cov.size() == 1, "Should be covered by [0, 8)");
+
+        // 1 defines also the bytes that are not covered by 3
+        std::tie(vals, cov, covered) = map.collect(Interval(0, 2), {});
+        check(vals == std::vector<int>({3, 1}), "Should be 3 and 1");
+
+        std::tie(vals, cov, covered) = map.collect(Interval(8, 4), {});
+        check(vals.empty() && !covered, "Should not find anything");
+
+        std::tie(vals, cov, covered)
+            = map.collect(Interval(4, 4), {Interval(4, 4)});
+        check(vals.empty() && !covered, "Should be already covered");
+
+        vals = map.collectAll(Interval(1, 2));
+        check(vals == std::vector<int>({3, 1}), "Should be 3 and 1");
+        vals = map.collectAll(Interval(0, analysis::Offset::UNKNOWN));
+        check(vals == std::vector<int>({3, 2, 1}), "Should be 3, 2 and 1");
+    }
+
     void test()
     {
         basic1();
         basic2();
         basic3();
         basic4();
+        blocks1();
+        blocks2();
+        demand1();
+        demand2();
+        maps1();
+        worklist1();
+        bitvector1();
+        bitvector2();
+        semisparse1();
+        semisparse_unknown1();
+        semisparse_unknown2();
+        semisparse_threads1();
+        phi_placement1();
+        interval_map1();
     }
 };
 
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+DG_TESTS_SLICER_FLAGS="-threads 2 -check-parallel-du"
+run_test "sources/global1.c"
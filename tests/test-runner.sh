@@ -109,7 +109,7 @@ run_test()
 		export DG_TESTS_RDA="-rda $DG_TESTS_RDA"
 	fi
 
-	llvm-slicer $DG_TESTS_RDA $DG_TESTS_PTA -c test_assert "$BCFILE"
+	llvm-slicer $DG_TESTS_RDA $DG_TESTS_PTA $DG_TESTS_SLICER_FLAGS -c test_assert "$BCFILE"
 
 	# link assert to the code
 	link_with_assert "$SLICEDFILE" "$LINKEDFILE"
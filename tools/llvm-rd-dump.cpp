@@ -140,7 +140,8 @@ printName(RDNode *node, bool dot)
 static void
 dumpMap(RDNode *node, bool dot = false)
 {
-    RDMap& map = node->getReachingDefinitions();
+    RDMap map;
+    node->getReachingDefinitions(map);
     for (const auto& it : map) {
         for (RDNode *site : it.second) {
             printName(it.first.target, dot);
@@ -252,7 +253,8 @@ dumpRDdot(LLVMReachingDefinitions *RD, bool dump_rd)
                    static_cast<void*>(succ));
         if (dump_rd) {
             // dump Reaching Definitions
-            auto rds = node->getReachingDefinitions();
+            RDMap rds;
+            node->getReachingDefinitions(rds);
             for (const auto& pair : rds) {
                 DefSite var = pair.first;
                 if (colors.find(var.target) == colors.end())
@@ -292,10 +294,13 @@ int main(int argc, char *argv[])
     llvm::SMDiagnostic SMD;
     bool todot = false;
     bool dump_rd = false;
+    bool statistics = false;
     const char *module = nullptr;
     Offset::type field_senitivity = Offset::UNKNOWN;
     bool rd_strong_update_unknown = false;
     Offset::type max_set_size = Offset::UNKNOWN;
+    // threads for the semi-sparse analysis, 0 means all
+    unsigned threads = 1;
 
     enum {
         FLOW_SENSITIVE = 1,
@@ -304,6 +309,10 @@ int main(int argc, char *argv[])
 
     enum class RdaType {
         DENSE,
+        DENSE_ROUNDS,
+        BLOCK,
+        BITVECTOR,
+        DEMAND,
         SEMISPARSE
     } rda = RdaType::DENSE;
 
@@ -316,6 +325,14 @@ int main(int argc, char *argv[])
         } else if (strcmp(argv[i], "-rda") == 0) {
             if (strcmp(argv[i+1], "ss") == 0)
                 rda = RdaType::SEMISPARSE;
+            else if (strcmp(argv[i+1], "rounds") == 0)
+                rda = RdaType::DENSE_ROUNDS;
+            else if (strcmp(argv[i+1], "block") == 0)
+                rda = RdaType::BLOCK;
+            else if (strcmp(argv[i+1], "bv") == 0)
+                rda = RdaType::BITVECTOR;
+            else if (strcmp(argv[i+1], "demand") == 0)
+                rda = RdaType::DEMAND;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<Offset::type>(atoll(argv[i + 1]));
         } else if (strcmp(argv[i], "-rd-max-set-size") == 0) {
@@ -324,6 +341,8 @@ int main(int argc, char *argv[])
                 llvm::errs() << "Invalid -rd-max-set-size argument\n";
                 abort();
             }
+        } else if (strcmp(argv[i], "-threads") == 0) {
+            threads = static_cast<unsigned>(atoi(argv[i + 1]));
         } else if (strcmp(argv[i], "-rd-strong-update-unknown") == 0) {
             rd_strong_update_unknown = true;
         } else if (strcmp(argv[i], "-dot") == 0) {
@@ -332,13 +351,15 @@ int main(int argc, char *argv[])
             verbose = true;
         } else if (strcmp(argv[i], "-dump-rd") == 0) {
             dump_rd = true;
+        } else if (strcmp(argv[i], "-statistics") == 0) {
+            statistics = true;
         } else {
             module = argv[i];
         }
     }
 
     if (!module) {
-        errs() << "Usage: % IR_module [-pts fs|fi] [-dot] [-v] [output_file]\n";
+        errs() << "Usage: % IR_module [-pts fs|fi] [-rda dense|rounds|block|bv|demand|ss] [-threads N] [-statistics] [-dot] [-v] [output_file]\n";
         return 1;
     }
 
@@ -371,15 +392,33 @@ int main(int argc, char *argv[])
     tm.stop();
     tm.report("INFO: Points-to analysis took");
 
-    LLVMReachingDefinitions RD(M, &PTA, rd_strong_update_unknown, max_set_size);
+    LLVMReachingDefinitions RD(M, &PTA, rd_strong_update_unknown,
+                               false /* pure funs */, max_set_size, threads);
     tm.start();
     if (rda == RdaType::SEMISPARSE) {
         RD.run<dg::analysis::rd::SemisparseRda>();
+    } else if (rda == RdaType::DENSE_ROUNDS) {
+        RD.run<dg::analysis::rd::RoundsReachingDefinitionsAnalysis>();
+    } else if (rda == RdaType::BLOCK) {
+        RD.run<dg::analysis::rd::BlockReachingDefinitionsAnalysis>();
+    } else if (rda == RdaType::BITVECTOR) {
+        RD.run<dg::analysis::rd::BVReachingDefinitionsAnalysis>();
+    } else if (rda == RdaType::DEMAND) {
+        RD.run<dg::analysis::rd::DemandReachingDefinitionsAnalysis>();
     } else
         RD.run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
     tm.stop();
     tm.report("INFO: Reaching definitions analysis took");
 
+    if (statistics) {
+        const auto& st = RD.getStatistics();
+        llvm::errs() << "INFO: Processed nodes: " << st.getProcessedNodes() << "\n";
+        llvm::errs() << "INFO: Processed blocks: " << st.getProcessedBlocks() << "\n";
+        llvm::errs() << "INFO: Iterations: " << st.getIterationsNum() << "\n";
+        llvm::errs() << "INFO: Merged maps: " << st.getMergesNum() << "\n";
+        llvm::errs() << "INFO: Skipped merges: " << st.getSkippedMergesNum() << "\n";
+    }
+
     dumpRD(&RD, todot, dump_rd);
 
     return 0;
@@ -81,7 +81,7 @@ enum PtaType {
 };
 
 enum RdaType {
-    dense, ss
+    dense, block, bv, demand, ss
 };
 
 llvm::cl::OptionCategory SlicingOpts("Slicer options", "");
@@ -141,6 +141,9 @@ llvm::cl::opt<RdaType> rda("rda",
     llvm::cl::desc("Choose reaching definitions analysis to use:"),
     llvm::cl::values(
         clEnumVal(dense, "Dense RDA (default)"),
+        clEnumVal(block, "Dense RDA that keeps definitions only at block entries"),
+        clEnumVal(bv, "Field-insensitive bitvector RDA (for big modules)"),
+        clEnumVal(demand, "Dense RDA that computes the definitions on demand"),
         clEnumVal(ss, "Semi-sparse RDA")
 #if LLVM_VERSION_MAJOR < 4
         , nullptr
@@ -159,8 +162,28 @@ llvm::cl::opt<CD_ALG> CdAlgorithm("cd-alg",
          ),
     llvm::cl::init(CD_ALG::CLASSIC), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> lazy_cd("lazy-cd",
+    llvm::cl::desc("Compute control dependencies only for the functions\n"
+                   "that are reached while searching the slice\n"),
+                   llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> threads("threads",
+    llvm::cl::desc("Use N threads for building the dependence graph and\n"
+                   "the sparse graph of the semi-sparse reaching definitions,\n"
+                   "adding def-use edges and computing control dependencies.\n"
+                   "The functions are processed in parallel,\n"
+                   "0 means to use all cores (default 1).\n"),
+                   llvm::cl::value_desc("N"), llvm::cl::init(1),
+                   llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> check_parallel_du("check-parallel-du",
+    llvm::cl::desc("Add the def-use edges in parallel and then serially\n"
+                   "and check that both ways give the same edges\n"),
+                   llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 
-static void annotate(llvm::Module *M, AnnotationOptsT opts,
+static void annotate(llvm::Module *M, const LLVMDependenceGraph *dg,
+                     AnnotationOptsT opts,
                      LLVMPointerAnalysis *PTA,
                      LLVMReachingDefinitions *RD)
 {
@@ -195,7 +218,7 @@ static void annotate(llvm::Module *M, AnnotationOptsT opts,
         module_comment += std::to_string(pta_field_sensitivie) + "\n\n";
 
     errs() << "INFO: Saving IR with annotations to " << fl << "\n";
-    auto annot = new dg::debug::LLVMDGAssemblyAnnotationWriter(opts, PTA, RD);
+    auto annot = new dg::debug::LLVMDGAssemblyAnnotationWriter(dg, opts, PTA, RD);
     annot->emitModuleComment(std::move(module_comment));
     M->print(outputstream, annot);
 
@@ -276,6 +299,12 @@ protected:
         tm.start();
         if (rda == dense) {
             RD->run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
+        } else if (rda == block) {
+            RD->run<dg::analysis::rd::BlockReachingDefinitionsAnalysis>();
+        } else if (rda == bv) {
+            RD->run<dg::analysis::rd::BVReachingDefinitionsAnalysis>();
+        } else if (rda == demand) {
+            RD->run<dg::analysis::rd::DemandReachingDefinitionsAnalysis>();
         } else if (rda == ss) {
             RD->run<dg::analysis::rd::SemisparseRda>();
         } else {
@@ -287,15 +316,36 @@ protected:
         LLVMDefUseAnalysis DUA(&dg, RD.get(),
                                PTA.get(), undefined_are_pure);
         tm.start();
-        DUA.run(); // add def-use edges according that
+        if (check_parallel_du) {
+            if (!DUA.checkParallel(threads)) {
+                errs() << "ERROR: parallel def-use edges differ from the serial ones\n";
+                abort();
+            }
+        } else if (threads != 1) {
+            DUA.runParallel(threads);
+        } else {
+            DUA.run(); // add def-use edges according that
+        }
         tm.stop();
         tm.report("INFO: Adding Def-Use edges took");
 
+        if (lazy_cd) {
+            // the control dependencies of a function are computed
+            // when the marking enters it the first time
+            slicer.computeControlDependenciesLazily(CdAlgorithm);
+        } else {
+            tm.start();
+            // add post-dominator frontiers
+            dg.computeControlDependencies(CdAlgorithm, threads);
+            tm.stop();
+            tm.report("INFO: Computing control dependencies took");
+        }
+
+        // the edges do not change until we slice the graph
         tm.start();
-        // add post-dominator frontiers
-        dg.computeControlDependencies(CdAlgorithm);
+        dg.freeze();
         tm.stop();
-        tm.report("INFO: Computing control dependencies took");
+        tm.report("INFO: Freezing the edges took");
     }
 
 public:
@@ -303,7 +353,8 @@ public:
     :M(mod), opts(o),
      PTA(new LLVMPointerAnalysis(mod, pta_field_sensitivie)),
       RD(new LLVMReachingDefinitions(mod, PTA.get(),
-                                     rd_strong_update_unknown, undefined_are_pure)) {
+                                     rd_strong_update_unknown, undefined_are_pure,
+                                     Offset::UNKNOWN, threads)) {
         assert(mod && "Need module");
     }
     const LLVMDependenceGraph& getDG() const { return dg; }
@@ -387,7 +438,7 @@ public:
 
         // print debugging llvm IR if user asked for it
         if (opts != 0)
-            annotate(M, opts, PTA.get(), RD.get());
+            annotate(M, &dg, opts, PTA.get(), RD.get());
 
         return true;
     }
@@ -436,7 +487,10 @@ public:
         tm.stop();
         tm.report("INFO: Points-to analysis took");
 
-        dg.build(&*M, PTA.get());
+        if (threads != 1)
+            dg.buildParallel(&*M, PTA.get(), threads);
+        else
+            dg.build(&*M, PTA.get());
 
         // verify if the graph is built correctly
         // FIXME - do it optionally (command line argument)